@@ -0,0 +1,48 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+/// @brief Blocking FIFO with a fixed capacity, connecting two pipeline stages. Push waits while the queue is
+/// full, Pop while it is empty. After Close, Push fails and Pop drains what is left, then fails.
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity(capacity) {}
+
+    bool Push(T item){
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [&]{ return closed || items.size() < capacity; });
+        if (closed) return false;
+        items.push_back(std::move(item));
+        not_empty.notify_one();
+        return true;
+    }
+
+    bool Pop(T& item){
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [&]{ return closed || !items.empty(); });
+        if (items.empty()) return false;
+        item = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    void Close(){
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        not_full.notify_all();
+        not_empty.notify_all();
+    }
+
+private:
+    size_t capacity;
+    std::deque<T> items;
+    bool closed = false;
+    std::mutex mutex;
+    std::condition_variable not_full, not_empty;
+};
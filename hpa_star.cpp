@@ -0,0 +1,286 @@
+#include "hpa_star.h"
+#include "maze.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+static const int HPA_CLUSTER_SIZE = 16;
+
+static std::mutex timings_mutex;
+static HpaTimings timings;
+
+struct ClusterBounds {
+    int x0, y0, x1, y1;     // Half-open cell range [x0, x1) x [y0, y1)
+
+    int Width() const {return x1 - x0;}
+    int Size() const {return (x1 - x0) * (y1 - y0);}
+    bool Contains(int x, int y) const {return x >= x0 && x < x1 && y >= y0 && y < y1;}
+};
+
+static ClusterBounds BoundsOf(const Maze& maze, int cluster_size, int clusters_x, int cluster){
+    int x0 = (cluster % clusters_x) * cluster_size;
+    int y0 = (cluster / clusters_x) * cluster_size;
+    return { x0, y0, std::min(maze.width(), x0 + cluster_size), std::min(maze.height(), y0 + cluster_size) };
+}
+
+/// @brief Breadth-first search from `source` that never leaves the cluster (Dijkstra if the maze is weighted)
+/// @param dist Output, cost from source per local cell index ((y - y0) * width + (x - x0)), -1 if unreachable
+/// @param parent Output, previous maze cell index per local cell index
+static void ClusterBFS(const Maze& maze, const ClusterBounds& bounds, int source, std::vector<int>& dist, std::vector<int>& parent){
+    auto local = [&](int cell){
+        return (cell / maze.width() - bounds.y0) * bounds.Width() + (cell % maze.width() - bounds.x0);
+    };
+    dist.assign(bounds.Size(), -1);
+    parent.assign(bounds.Size(), -1);
+    dist[local(source)] = 0;
+
+    if (maze.Weighted()){
+        using Entry = std::pair<int, int>;     // (cost, cell)
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open_set;
+        open_set.push({0, source});
+        while (!open_set.empty()){
+            auto [cost, current] = open_set.top();
+            open_set.pop();
+            if (cost != dist[local(current)]) continue;     // Outdated entry
+            uint8_t open = maze.OpenSides(current);
+            for (int dir = 0; dir < 4; dir++){
+                if (!(open & (1 << dir))) continue;
+                int neighbour = maze.Neighbour(current, dir);
+                if (!bounds.Contains(neighbour % maze.width(), neighbour / maze.width())) continue;
+                int l = local(neighbour);
+                int tentative = cost + maze.Weight(current, dir);
+                if (dist[l] != -1 && dist[l] <= tentative) continue;
+                dist[l] = tentative;
+                parent[l] = current;
+                open_set.push({tentative, neighbour});
+            }
+        }
+        return;
+    }
+
+    std::deque<int> queue = { source };
+    while (!queue.empty()){
+        int current = queue.front();
+        queue.pop_front();
+        uint8_t open = maze.OpenSides(current);
+        for (int dir = 0; dir < 4; dir++){
+            if (!(open & (1 << dir))) continue;
+            int neighbour = maze.Neighbour(current, dir);
+            if (!bounds.Contains(neighbour % maze.width(), neighbour / maze.width())) continue;
+            int l = local(neighbour);
+            if (dist[l] != -1) continue;
+            dist[l] = dist[local(current)] + 1;
+            parent[l] = current;
+            queue.push_back(neighbour);
+        }
+    }
+}
+
+/// @brief Find the entrances and precompute entrance-to-entrance distances of every cluster (in parallel across clusters)
+HpaGraph::HpaGraph(const Maze& maze, int cluster_size)
+: width(maze.width()), cluster_size(cluster_size), clusters_x((maze.width() + cluster_size - 1) / cluster_size)
+{
+    int clusters_y = (maze.height() + cluster_size - 1) / cluster_size;
+    int num_clusters = clusters_x * clusters_y;
+    int num_cells = maze.width() * maze.height();
+
+    node_of.assign(num_cells, -1);
+    std::vector<std::vector<int>> cluster_nodes(num_clusters);
+    for (int c = 0; c < num_cells; c++){
+        uint8_t open = maze.OpenSides(c);
+        for (int dir = 0; dir < 4; dir++){
+            if ((open & (1 << dir)) && ClusterOf(maze.Neighbour(c, dir)) != ClusterOf(c)){
+                node_of[c] = (int)node_cell.size();
+                node_cell.push_back(c);
+                cluster_nodes[ClusterOf(c)].push_back(node_of[c]);
+                break;
+            }
+        }
+    }
+
+    // Each node's edge list is only written by the thread that owns its cluster
+    std::vector<std::vector<HpaEdge>> adjacency(NumNodes());
+    #pragma omp parallel for schedule(dynamic)
+    for (int cluster = 0; cluster < num_clusters; cluster++){
+        ClusterBounds bounds = BoundsOf(maze, cluster_size, clusters_x, cluster);
+        std::vector<int> dist, parent;
+        for (int u : cluster_nodes[cluster]){
+            int u_cell = node_cell[u];
+            uint8_t open = maze.OpenSides(u_cell);
+            for (int dir = 0; dir < 4; dir++){
+                if (!(open & (1 << dir))) continue;
+                int neighbour = maze.Neighbour(u_cell, dir);
+                if (ClusterOf(neighbour) != cluster) adjacency[u].push_back({node_of[neighbour], maze.Weight(u_cell, dir)});
+            }
+
+            ClusterBFS(maze, bounds, u_cell, dist, parent);
+            for (int v : cluster_nodes[cluster]){
+                int v_cell = node_cell[v];
+                int d = dist[(v_cell / width - bounds.y0) * bounds.Width() + (v_cell % width - bounds.x0)];
+                if (v != u && d != -1) adjacency[u].push_back({v, d});
+            }
+        }
+    }
+
+    edge_offset.push_back(0);
+    for (const std::vector<HpaEdge>& node_edges : adjacency){
+        edges.insert(edges.end(), node_edges.begin(), node_edges.end());
+        edge_offset.push_back((int)edges.size());
+    }
+}
+
+/// @brief Connect a cell that may not be an entrance to the entrances of its cluster
+/// @return (entrance node, distance) for every entrance reachable inside the cluster
+static std::vector<HpaEdge> ConnectToCluster(const Maze& maze, const HpaGraph& graph, int cell){
+    ClusterBounds bounds = BoundsOf(maze, graph.cluster_size, graph.clusters_x, graph.ClusterOf(cell));
+    std::vector<int> dist, parent;
+    ClusterBFS(maze, bounds, cell, dist, parent);
+
+    std::vector<HpaEdge> connections;
+    for (int y = bounds.y0; y < bounds.y1; y++){
+        for (int x = bounds.x0; x < bounds.x1; x++){
+            int node = graph.node_of[y * maze.width() + x];
+            int d = dist[(y - bounds.y0) * bounds.Width() + (x - bounds.x0)];
+            if (node != -1 && d != -1) connections.push_back({node, d});
+        }
+    }
+    return connections;
+}
+
+/// @brief Append the cells after `from` up to and including `to`. Both are in the same cluster or adjacent across a border.
+static void RefineSegment(Maze& maze, const HpaGraph& graph, int from, int to, std::vector<Cell *>& path){
+    if (from == to) return;
+    if (graph.ClusterOf(from) != graph.ClusterOf(to)){
+        path.push_back(maze.CellAt(to));
+        return;
+    }
+
+    ClusterBounds bounds = BoundsOf(maze, graph.cluster_size, graph.clusters_x, graph.ClusterOf(from));
+    std::vector<int> dist, parent;
+    ClusterBFS(maze, bounds, from, dist, parent);
+
+    std::vector<Cell *> segment;
+    for (int c = to; c != from; c = parent[(c / maze.width() - bounds.y0) * bounds.Width() + (c % maze.width() - bounds.x0)]){
+        segment.push_back(maze.CellAt(c));
+    }
+    path.insert(path.end(), segment.rbegin(), segment.rend());
+}
+
+/// @brief Hierarchical A* (HPA*). Searches the cached abstract graph of the maze, then refines each abstract edge
+/// with a search inside one cluster. Returns a shortest path, since every border crossing is an entrance.
+/// @param maze
+/// @return Vector of Cell from start to finish. {} if no path is found.
+std::vector<Cell *> HpaStar(Maze &maze){
+    if (!maze.start || !maze.finish) return {};
+    if (maze.start == maze.finish) return { maze.start };
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    bool built = false;
+    if (!maze.hpa_graph){
+        maze.hpa_graph = std::make_shared<const HpaGraph>(maze, HPA_CLUSTER_SIZE);
+        built = true;
+    }
+    const HpaGraph &graph = *maze.hpa_graph;
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    // Abstract graph plus two temporary nodes for start and finish
+    int num_nodes = graph.NumNodes();
+    int start = num_nodes;
+    int finish = num_nodes + 1;
+    int start_cell = maze.Index(maze.start);
+    int finish_cell = maze.Index(maze.finish);
+
+    std::vector<HpaEdge> start_edges = ConnectToCluster(maze, graph, start_cell);
+    std::vector<int> finish_weight(num_nodes, -1);
+    for (const HpaEdge &edge : ConnectToCluster(maze, graph, finish_cell)) finish_weight[edge.to] = edge.weight;
+    if (graph.ClusterOf(start_cell) == graph.ClusterOf(finish_cell)){
+        ClusterBounds bounds = BoundsOf(maze, graph.cluster_size, graph.clusters_x, graph.ClusterOf(start_cell));
+        std::vector<int> dist, parent;
+        ClusterBFS(maze, bounds, start_cell, dist, parent);
+        int d = dist[(maze.finish->posY - bounds.y0) * bounds.Width() + (maze.finish->posX - bounds.x0)];
+        if (d != -1) start_edges.push_back({finish, d});
+    }
+
+    auto cell_of = [&](int node){
+        if (node == start) return start_cell;
+        if (node == finish) return finish_cell;
+        return graph.node_cell[node];
+    };
+    auto heuristic = [&](int node){
+        int cell = cell_of(node);
+        return std::abs(cell % maze.width() - maze.finish->posX) + std::abs(cell / maze.width() - maze.finish->posY);
+    };
+
+    std::vector<int> g_cost(num_nodes + 2, std::numeric_limits<int>::max());
+    std::vector<int> parent_of(num_nodes + 2, -1);
+    std::vector<bool> closed(num_nodes + 2, false);
+
+    using Entry = std::pair<int, int>;     // (f_cost, node)
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open_set;
+    g_cost[start] = 0;
+    open_set.push({heuristic(start), start});
+
+    auto relax = [&](int current, int to, int weight){
+        int tentative_g_cost = g_cost[current] + weight;
+        if (tentative_g_cost < g_cost[to]){
+            g_cost[to] = tentative_g_cost;
+            parent_of[to] = current;
+            open_set.push({tentative_g_cost + heuristic(to), to});
+        }
+    };
+
+    while (!open_set.empty()){
+        int current = open_set.top().second;
+        open_set.pop();
+        if (closed[current]) continue;
+        closed[current] = true;
+        if (current == finish) break;
+
+        if (current == start){
+            for (const HpaEdge &edge : start_edges) relax(current, edge.to, edge.weight);
+            continue;
+        }
+        for (int e = graph.edge_offset[current]; e < graph.edge_offset[current + 1]; e++){
+            relax(current, graph.edges[e].to, graph.edges[e].weight);
+        }
+        if (finish_weight[current] != -1) relax(current, finish, finish_weight[current]);
+    }
+
+    std::vector<Cell *> path;
+    if (closed[finish]){
+        std::vector<int> abstract_path;
+        for (int node = finish; node != -1; node = parent_of[node]) abstract_path.push_back(cell_of(node));
+        std::reverse(abstract_path.begin(), abstract_path.end());
+
+        path.push_back(maze.start);
+        for (size_t i = 1; i < abstract_path.size(); i++){
+            RefineSegment(maze, graph, abstract_path[i - 1], abstract_path[i], path);
+        }
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    std::lock_guard<std::mutex> lock(timings_mutex);
+    if (built){
+        timings.preprocess_ms += std::chrono::duration<double, std::milli>(t1 - t0).count();
+        timings.graphs_built++;
+    }
+    timings.query_ms += std::chrono::duration<double, std::milli>(t2 - t1).count();
+    timings.queries++;
+    return path;
+}
+
+/// @brief Return the timings accumulated since the last call and reset them
+HpaTimings HpaTakeTimings(){
+    std::lock_guard<std::mutex> lock(timings_mutex);
+    HpaTimings taken = timings;
+    timings = HpaTimings();
+    return taken;
+}
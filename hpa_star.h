@@ -0,0 +1,39 @@
+#pragma once
+#include "maze.h"
+
+#include <vector>
+
+struct HpaEdge {
+    int to;
+    int weight;
+};
+
+/// @brief Abstract graph for hierarchical pathfinding. The maze is split into square clusters,
+/// every cell with a passage into another cluster is an entrance node, and entrances of the same
+/// cluster are linked by their shortest distance inside the cluster.
+class HpaGraph {
+public:
+    HpaGraph(const Maze& maze, int cluster_size);
+
+    int NumNodes() const {return (int)node_cell.size();}
+    int ClusterOf(int cell) const {return (cell / width / cluster_size) * clusters_x + (cell % width) / cluster_size;}
+
+    int width;
+    int cluster_size;
+    int clusters_x;
+    std::vector<int> node_cell;     // Cell index of each entrance node
+    std::vector<int> node_of;       // Node id of each cell, -1 if not an entrance
+    std::vector<int> edge_offset;   // Edges of node n are edges[edge_offset[n] .. edge_offset[n + 1])
+    std::vector<HpaEdge> edges;
+};
+
+/// @brief Accumulated HPA* timings, so preprocessing can be amortized over queries
+struct HpaTimings {
+    double preprocess_ms = 0;
+    double query_ms = 0;
+    int graphs_built = 0;
+    int queries = 0;
+};
+
+std::vector<Cell *> HpaStar(Maze &maze);
+HpaTimings HpaTakeTimings();
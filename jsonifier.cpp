@@ -6,88 +6,220 @@
 
 /* ULTRA AIDS INCOMING */
 
-/// @brief Convert maze vector to JSON string
+/// @brief Append one maze (size, start, finish, cells and passages) as a JSON object
+static void MazeToJSON(std::ostringstream& oss, const Maze& maze) {
+    oss << "{";
+    oss << "\"width\":" << maze.width() << ",";
+    oss << "\"height\":" << maze.height() << ",";
+    oss << "\"start\":{\"x\":" << maze.start->posX << ",\"y\":" << maze.start->posY << "}" << ",";
+    oss << "\"finish\":{\"x\":" << maze.finish->posX << ",\"y\":" << maze.finish->posY << "}" << ",";
+    oss << "\"cells\":";
+    oss << "["; // JSON array
+    bool firstCell = true;
+    // Serialize cells (fill JSON array with cells)
+    for (size_t y = 0; y < maze.height(); ++y) {
+        for (size_t x = 0; x < maze.width(); ++x) {
+            if (!firstCell) oss << ",";
+            firstCell = false;
+
+            const Cell& cell = maze.cells[y][x];
+            oss << "{";
+            oss << "\"x\":" << cell.posX << ",";
+            oss << "\"y\":" << cell.posY << ",";
+            oss << "\"inMaze\":" << (cell.inMaze ? "true" : "false") << ",";
+            oss << "\"inFrontier\":" << (cell.inFrontier ? "true" : "false");
+            oss << "}";
+        }
+    }
+    oss << "],";
+    // Serialize passages (fill JSON array with passages)
+    oss << "\"passages\":";
+    oss << "["; // JSON array
+    for (size_t j = 0; j < maze.passages.size(); ++j) {
+        if(j > 0) oss << ",";   // Add comma before each passage except the first
+        const Passage& passage = maze.passages[j];
+        oss << "{";
+        oss << "\"c1\":{" << "\"x\":" << passage.c1->posX << "," << "\"y\":" << passage.c1->posY << "},";
+        oss << "\"c2\":{" << "\"x\":" << passage.c2->posX << "," << "\"y\":" << passage.c2->posY << "}";
+        if (maze.Weighted()) oss << ",\"w\":" << maze.Weight(passage.c1, passage.c2);
+        oss << "}";
+    }
+    oss << "]";
+    oss << "}";
+}
+
+/// @brief Convert the maze collection to JSON string. Mazes are materialized page by page while serializing,
+/// so the reported generation time is the time spent generating them here.
+/// @param generationTime Set to the generation time in ms
 /// @return JSON string representing the mazes and generation time
-std::string MazesToJSON(const std::vector<Maze>& mazes, const double generationTime) {
+std::string MazesToJSON(MazeCollection& mazes, double& generationTime) {
+    std::ostringstream body;
+    mazes.TakeGenerationMs();
+    mazes.ForEachPage(0, mazes.size(), [&](std::vector<Maze>& page, int page_begin, int local_begin, int local_end){
+        for (int i = local_begin; i < local_end; i++){
+            if (page_begin + i > 0) body << ",";   // Add comma before each maze except the first
+            MazeToJSON(body, page[i]);
+        }
+    });
+    generationTime = mazes.TakeGenerationMs();
+
     std::ostringstream oss;
     oss << "{"; // JSON object
     oss << "\"numMazes\":" << mazes.size() << ",";
     oss << "\"generationTime\":" << generationTime << ",";
-    oss << "\"mazes\":[";
+    oss << "\"mazes\":[" << body.str() << "]";
+    oss << "}";
 
-    for (size_t i = 0; i < mazes.size(); i++){
-        if(i > 0) oss << ",";   // Add comma before each maze except the first
-        const Maze &maze = mazes[i];
+    return oss.str();
+}
 
+/// @brief Append path i of the set as a JSON array of {x, y}
+static void PathToJSON(std::ostringstream& oss, const PathSet& paths, size_t i) {
+    oss << "["; // JSON array for the path
+    for(size_t j = 0; j < paths.Length(i); j++){
+        if(j > 0) oss << ",";   // Add comma before each cell except the first
         oss << "{";
-        oss << "\"width\":" << maze.width() << ",";
-        oss << "\"height\":" << maze.height() << ",";
-        oss << "\"start\":{\"x\":" << maze.start->posX << ",\"y\":" << maze.start->posY << "}" << ",";
-        oss << "\"finish\":{\"x\":" << maze.finish->posX << ",\"y\":" << maze.finish->posY << "}" << ",";
-        oss << "\"cells\":";
-        oss << "["; // JSON array
-        bool firstCell = true;
-        // Serialize cells (fill JSON array with cells)
-        for (size_t y = 0; y < maze.height(); ++y) {
-            for (size_t x = 0; x < maze.width(); ++x) {
-                if (!firstCell) oss << ",";
-                firstCell = false;
-
-                const Cell& cell = maze.cells[y][x];
-                oss << "{";
-                oss << "\"x\":" << cell.posX << ",";
-                oss << "\"y\":" << cell.posY << ",";
-                oss << "\"inMaze\":" << (cell.inMaze ? "true" : "false") << ",";
-                oss << "\"inFrontier\":" << (cell.inFrontier ? "true" : "false");
-                oss << "}";
-            }
-        }
-        oss << "],";
-        // Serialize passages (fill JSON array with passages)
-        oss << "\"passages\":";
-        oss << "["; // JSON array
-        for (size_t j = 0; j < maze.passages.size(); ++j) {
-            if(j > 0) oss << ",";   // Add comma before each passage except the first
-            const Passage& passage = maze.passages[j];
-            oss << "{";
-            oss << "\"c1\":{" << "\"x\":" << passage.c1->posX << "," << "\"y\":" << passage.c1->posY << "},";
-            oss << "\"c2\":{" << "\"x\":" << passage.c2->posX << "," << "\"y\":" << passage.c2->posY << "}";
-            oss << "}";
-        }
-        oss << "]";
+        oss << "\"x\":" << paths.X(i, j) << ",";
+        oss << "\"y\":" << paths.Y(i, j);
         oss << "}";
     }
-    
-    oss << "]"; // End of mazes array
-    oss << "}";
+    oss << "]"; // End single path
+}
 
-    return oss.str();
+/// @brief Write how a solve ended: "complete", and for a stopped solve the reason, which mazes were finished and
+/// the cost bounds of the maze an intra-maze search was interrupted in
+static void SolveStatusToJSON(std::ostringstream& oss, const SolveStatus& status) {
+    oss << "\"complete\":" << (status.stopped ? "false" : "true") << ",";
+    if (!status.stopped) return;
+    oss << "\"stopReason\":\"" << status.reason << "\",";
+    oss << "\"solved\":[";
+    for (size_t i = 0; i < status.solved.size(); ++i) {
+        if(i > 0) oss << ",";
+        oss << (int)status.solved[i];
+    }
+    oss << "],";
+    if (status.bound_maze >= 0) {
+        oss << "\"bound\":{\"maze\":" << status.bound_maze << ",\"lower\":" << status.lower_bound << ",\"upper\":" << status.upper_bound << "},";
+    }
 }
 
 /// @brief Convert path vector to JSON string
+/// @param status How the solve ended, nullptr to leave it out
+/// @param generationTime Time spent materializing mazes during the solve (lazy batches), negative to leave it out
 /// @return JSON string representing the paths and solving time
-std::string PathsToJSON(const std::vector<std::vector<Cell *>>& paths, double solvingTime) {
+std::string PathsToJSON(const PathSet& paths, double solvingTime, const SolveStatus* status, double generationTime) {
     std::ostringstream oss;
     oss << "{";
     oss << "\"solvingTime\":" << solvingTime << ",";
+    if (generationTime >= 0) oss << "\"generationTime\":" << generationTime << ",";
+    if (status) SolveStatusToJSON(oss, *status);
     oss << "\"paths\":[";
     for (size_t i = 0; i < paths.size(); ++i) {
         if(i > 0) oss << ",";   // Add comma before each cell except the first
-        const std::vector<Cell *>& path = paths[i];
         
-        oss << "["; // JSON array for the path
-        for(size_t j = 0; j < path.size(); j++){
-            if(j > 0) oss << ",";   // Add comma before each cell except the first
-            const Cell& cell = *path[j];
-            oss << "{";
-            oss << "\"x\":" << cell.posX << ",";
-            oss << "\"y\":" << cell.posY;
-            oss << "}";
-        }
-        oss << "]"; // End single path
+        PathToJSON(oss, paths, i);
+    }
+
+    oss << "]";
+    oss << "}";
+
+    return oss.str();
+}
+
+/// @brief Convert one maze and its path to JSON string, used by the streamed generate-and-solve
+/// @return JSON object with the maze index, the maze (same format as MazesToJSON) and the path
+std::string MazeResultToJSON(int index, const Maze& maze, const PathSet& paths, size_t path) {
+    std::ostringstream oss;
+    oss << "{\"index\":" << index << ",\"maze\":";
+    MazeToJSON(oss, maze);
+    oss << ",\"path\":";
+    PathToJSON(oss, paths, path);
+    oss << "}";
+    return oss.str();
+}
+
+/// @brief Convert one maze of the batch to JSON string, same format as MazeResultToJSON without the path
+std::string MazeToJSON(int index, const Maze& maze) {
+    std::ostringstream oss;
+    oss << "{\"index\":" << index << ",\"maze\":";
+    MazeToJSON(oss, maze);
+    oss << "}";
+    return oss.str();
+}
+
+/// @brief Convert the size, start and finish of one maze to JSON string, for clients that draw it from tiles
+/// @param pathLength Length of the solved path, -1 if there is no solution yet
+std::string MazeSummaryToJSON(int index, const Maze& maze, long pathLength) {
+    std::ostringstream oss;
+    oss << "{\"index\":" << index << ",\"maze\":{";
+    oss << "\"width\":" << maze.width() << ",";
+    oss << "\"height\":" << maze.height() << ",";
+    oss << "\"start\":{\"x\":" << maze.start->posX << ",\"y\":" << maze.start->posY << "}" << ",";
+    oss << "\"finish\":{\"x\":" << maze.finish->posX << ",\"y\":" << maze.finish->posY << "}";
+    oss << "},\"pathLength\":" << pathLength << "}";
+    return oss.str();
+}
+
+/// @brief Convert the batch parameters to JSON string, without materializing any maze
+/// @param generationTime Left out if negative (the mazes have not been generated yet)
+std::string BatchToJSON(const MazeCollection& mazes, bool solved, double generationTime) {
+    std::ostringstream oss;
+    oss << "{";
+    oss << "\"numMazes\":" << mazes.size() << ",";
+    oss << "\"width\":" << mazes.width() << ",";
+    oss << "\"height\":" << mazes.height() << ",";
+    oss << "\"braid\":" << mazes.Options().braid << ",";
+    oss << "\"maxWeight\":" << mazes.Options().max_weight << ",";
+    oss << "\"solved\":" << (solved ? "true" : "false");
+    if (generationTime >= 0) oss << ",\"generationTime\":" << generationTime;
+    oss << "}";
+    return oss.str();
+}
+
+/// @brief Convert path lengths (not the paths) to JSON string, for clients that fetch paths per maze
+/// @param generationTime As for PathsToJSON
+std::string PathLengthsToJSON(const PathSet& paths, double solvingTime, const SolveStatus* status, double generationTime) {
+    std::ostringstream oss;
+    oss << "{";
+    oss << "\"solvingTime\":" << solvingTime << ",";
+    if (generationTime >= 0) oss << "\"generationTime\":" << generationTime << ",";
+    if (status) SolveStatusToJSON(oss, *status);
+    oss << "\"pathLengths\":[";
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if(i > 0) oss << ",";
+        oss << paths.Length(i);
     }
+    oss << "]";
+    oss << "}";
+    return oss.str();
+}
 
+/// @brief Convert pair query results to JSON string
+/// @param paths Cell index paths, one per query, or empty if paths were not requested
+/// @return JSON string with one distance per query (-1 for invalid cells), optional paths and query time
+std::string PairQueriesToJSON(const Maze& maze, const std::vector<int>& distances, const std::vector<std::vector<int>>& paths, double queryTime) {
+    std::ostringstream oss;
+    oss << "{";
+    oss << "\"queryTime\":" << queryTime << ",";
+    oss << "\"distances\":[";
+    for (size_t i = 0; i < distances.size(); ++i) {
+        if(i > 0) oss << ",";
+        oss << distances[i];
+    }
     oss << "]";
+    if (!paths.empty()) {
+        oss << ",\"paths\":[";
+        for (size_t i = 0; i < paths.size(); ++i) {
+            if(i > 0) oss << ",";
+            oss << "[";
+            for (size_t j = 0; j < paths[i].size(); j++) {
+                if(j > 0) oss << ",";
+                oss << "{\"x\":" << paths[i][j] % maze.width() << ",\"y\":" << paths[i][j] / maze.width() << "}";
+            }
+            oss << "]";
+        }
+        oss << "]";
+    }
     oss << "}";
 
     return oss.str();
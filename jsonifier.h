@@ -1,8 +1,15 @@
 #include "solve_a_star.h"
 #include "maze.h"
+#include "maze_collection.h"
 #include "stdio.h"
 #include <sstream>
 #include <vector>
 
-std::string MazesToJSON(const std::vector<Maze>& mazes, const double generationTime);
-std::string PathsToJSON(const std::vector<std::vector<Cell *>>& paths, double solvingTime);
\ No newline at end of file
+std::string MazesToJSON(MazeCollection& mazes, double& generationTime);
+std::string PathsToJSON(const PathSet& paths, double solvingTime, const SolveStatus* status = nullptr, double generationTime = -1);
+std::string MazeResultToJSON(int index, const Maze& maze, const PathSet& paths, size_t path);
+std::string MazeToJSON(int index, const Maze& maze);
+std::string MazeSummaryToJSON(int index, const Maze& maze, long pathLength);
+std::string BatchToJSON(const MazeCollection& mazes, bool solved, double generationTime);
+std::string PathLengthsToJSON(const PathSet& paths, double solvingTime, const SolveStatus* status = nullptr, double generationTime = -1);
+std::string PairQueriesToJSON(const Maze& maze, const std::vector<int>& distances, const std::vector<std::vector<int>>& paths, double queryTime);
@@ -0,0 +1,132 @@
+#include "junction_graph.h"
+#include "maze.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <vector>
+
+static int OpenCount(uint8_t open){
+    return __builtin_popcount(open);
+}
+
+/// @brief Follow a corridor from cell `from` through side (1 << dir) until the next node
+/// @param visit Called with every cell after `from`, including the node reached, and the cost of the step into it
+/// @return Cell index of the node reached
+template <typename Visit>
+static int WalkCorridor(const Maze& maze, const std::vector<int>& node_of, int from, int dir, Visit visit){
+    int previous = from;
+    int current = maze.Neighbour(from, dir);
+    visit(current, maze.Weight(from, dir));
+    while (node_of[current] == -1){
+        uint8_t open = maze.OpenSides(current);
+        for (int d = 0; d < 4; d++){
+            if (!(open & (1 << d))) continue;
+            int next = maze.Neighbour(current, d);
+            if (next == previous) continue;
+            visit(next, maze.Weight(current, d));
+            previous = current;
+            current = next;
+            break;
+        }
+    }
+    return current;
+}
+
+/// @brief Contract the maze. Nodes are every cell without exactly two open sides, plus start and finish.
+JunctionGraph::JunctionGraph(const Maze& maze){
+    int num_cells = maze.width() * maze.height();
+    node_of.assign(num_cells, -1);
+    for (int c = 0; c < num_cells; c++){
+        bool endpoint = (maze.start && c == maze.Index(maze.start)) || (maze.finish && c == maze.Index(maze.finish));
+        if (endpoint || OpenCount(maze.OpenSides(c)) != 2){
+            node_of[c] = (int)node_cell.size();
+            node_cell.push_back(c);
+        }
+    }
+
+    edge_offset.push_back(0);
+    for (int node = 0; node < NumNodes(); node++){
+        int cell = node_cell[node];
+        uint8_t open = maze.OpenSides(cell);
+        for (int dir = 0; dir < 4; dir++){
+            if (!(open & (1 << dir))) continue;
+            int weight = 0;
+            int end = WalkCorridor(maze, node_of, cell, dir, [&](int, int step_cost){ weight += step_cost; });
+            if (end == cell) continue;  // Corridor loops back to the same node, never on a shortest path
+            edges.push_back({node_of[end], weight, dir});
+        }
+        edge_offset.push_back((int)edges.size());
+    }
+}
+
+/// @brief A* over the junction graph of the maze. The graph is built on first use and cached in the maze.
+/// @param maze
+/// @return Vector of Cell from start to finish with corridors expanded. {} if no path is found.
+std::vector<Cell *> AStarJunction(Maze &maze){
+    if (!maze.start || !maze.finish) return {};
+    if (maze.start == maze.finish) return { maze.start };
+
+    if (!maze.junction_graph){
+        maze.junction_graph = std::make_shared<const JunctionGraph>(maze);
+    }
+    const JunctionGraph &graph = *maze.junction_graph;
+
+    int start = graph.node_of[maze.Index(maze.start)];
+    int finish = graph.node_of[maze.Index(maze.finish)];
+    int finish_x = maze.finish->posX;
+    int finish_y = maze.finish->posY;
+    auto heuristic = [&](int node){
+        int cell = graph.node_cell[node];
+        return std::abs(cell % maze.width() - finish_x) + std::abs(cell / maze.width() - finish_y);
+    };
+
+    std::vector<int> g_cost(graph.NumNodes(), std::numeric_limits<int>::max());
+    std::vector<int> parent_edge(graph.NumNodes(), -1);     // Edge used to reach the node
+    std::vector<int> parent_node(graph.NumNodes(), -1);
+    std::vector<bool> closed(graph.NumNodes(), false);
+
+    // (f_cost, node), smallest f first
+    using Entry = std::pair<int, int>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open_set;
+    g_cost[start] = 0;
+    open_set.push({heuristic(start), start});
+
+    while (!open_set.empty()){
+        int current = open_set.top().second;
+        open_set.pop();
+        if (closed[current]) continue;
+        closed[current] = true;
+        if (current == finish) break;
+
+        for (int e = graph.edge_offset[current]; e < graph.edge_offset[current + 1]; e++){
+            const JunctionEdge &edge = graph.edges[e];
+            int tentative_g_cost = g_cost[current] + edge.weight;
+            if (tentative_g_cost < g_cost[edge.to]){
+                g_cost[edge.to] = tentative_g_cost;
+                parent_edge[edge.to] = e;
+                parent_node[edge.to] = current;
+                open_set.push({tentative_g_cost + heuristic(edge.to), edge.to});
+            }
+        }
+    }
+
+    if (!closed[finish]) return {};
+
+    // Expand the corridors of the node path back into cells
+    std::vector<int> node_path;
+    for (int node = finish; node != -1; node = parent_node[node]) node_path.push_back(node);
+    std::reverse(node_path.begin(), node_path.end());
+
+    std::vector<Cell *> path = { maze.CellAt(graph.node_cell[start]) };
+    for (size_t i = 1; i < node_path.size(); i++){
+        const JunctionEdge &edge = graph.edges[parent_edge[node_path[i]]];
+        WalkCorridor(maze, graph.node_of, graph.node_cell[node_path[i - 1]], edge.dir, [&](int cell, int){
+            path.push_back(maze.CellAt(cell));
+        });
+    }
+    return path;
+}
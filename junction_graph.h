@@ -0,0 +1,27 @@
+#pragma once
+#include "maze.h"
+
+#include <vector>
+
+/// @brief A corridor between two junctions, walked from `from` through side (1 << dir)
+struct JunctionEdge {
+    int to;         // Node id at the other end
+    int weight;     // Cost along the corridor (steps, or the sum of passage weights)
+    int dir;        // First step out of the source node
+};
+
+/// @brief Maze contracted to its junctions, dead ends, start and finish.
+/// Chains of cells with exactly two open sides become single weighted edges.
+class JunctionGraph {
+public:
+    explicit JunctionGraph(const Maze& maze);
+
+    int NumNodes() const {return (int)node_cell.size();}
+
+    std::vector<int> node_cell;     // Cell index of each node
+    std::vector<int> node_of;       // Node id of each cell, -1 for corridor cells
+    std::vector<int> edge_offset;   // Edges of node n are edges[edge_offset[n] .. edge_offset[n + 1])
+    std::vector<JunctionEdge> edges;
+};
+
+std::vector<Cell *> AStarJunction(Maze &maze);
@@ -0,0 +1,96 @@
+#include "lpa_star.h"
+#include "maze.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+static const int INF = std::numeric_limits<int>::max() / 2;
+
+LpaStar::LpaStar(Maze& maze)
+: maze(maze), start(maze.Index(maze.start)), finish(maze.Index(maze.finish))
+{
+    int num_cells = maze.width() * maze.height();
+    g.assign(num_cells, INF);
+    rhs.assign(num_cells, INF);
+    rhs[start] = 0;
+    open_set.push({CalculateKey(start), start});
+}
+
+int LpaStar::Heuristic(int cell) const {
+    return std::abs(cell % maze.width() - finish % maze.width()) + std::abs(cell / maze.width() - finish / maze.width());
+}
+
+LpaStar::Key LpaStar::CalculateKey(int cell) const {
+    int best = std::min(g[cell], rhs[cell]);
+    return { best + Heuristic(cell), best };
+}
+
+/// @brief Recompute rhs of a cell from its neighbours and (re)queue it if it is inconsistent
+void LpaStar::UpdateCell(int cell){
+    if (cell != start){
+        int best = INF;
+        uint8_t open = maze.OpenSides(cell);
+        for (int dir = 0; dir < 4; dir++){
+            if (open & (1 << dir)) best = std::min(best, g[maze.Neighbour(cell, dir)] + maze.Weight(cell, dir));
+        }
+        rhs[cell] = std::min(best, INF);
+    }
+    // Stale queue entries are skipped when popped, so there is no need to remove the old one
+    if (g[cell] != rhs[cell]) open_set.push({CalculateKey(cell), cell});
+}
+
+void LpaStar::ComputeShortestPath(){
+    last_expansions = 0;
+    while (!open_set.empty()){
+        auto [key, current] = open_set.top();
+        if (g[current] == rhs[current] || key != CalculateKey(current)){
+            open_set.pop();     // Consistent or outdated entry
+            continue;
+        }
+        if (!(key < CalculateKey(finish)) && rhs[finish] == g[finish]) break;
+        open_set.pop();
+        last_expansions++;
+
+        if (g[current] > rhs[current]){
+            g[current] = rhs[current];
+        } else {
+            g[current] = INF;
+            UpdateCell(current);
+        }
+        uint8_t open = maze.OpenSides(current);
+        for (int dir = 0; dir < 4; dir++){
+            if (open & (1 << dir)) UpdateCell(maze.Neighbour(current, dir));
+        }
+    }
+}
+
+/// @brief Tell the solver that the wall between a and b was opened or closed (the maze must already be edited)
+void LpaStar::PassageChanged(const Cell* a, const Cell* b){
+    UpdateCell(maze.Index(a));
+    UpdateCell(maze.Index(b));
+}
+
+/// @brief Bring the search up to date and return the current shortest path
+/// @return Vector of Cell from start to finish. {} if no path exists.
+std::vector<Cell *> LpaStar::Solve(){
+    ComputeShortestPath();
+    if (g[finish] >= INF) return {};
+
+    // Walk back from the finish along neighbours whose g is exactly one step cost less
+    std::vector<Cell *> path = { maze.CellAt(finish) };
+    for (int current = finish; current != start; ){
+        int previous = -1;
+        uint8_t open = maze.OpenSides(current);
+        for (int dir = 0; dir < 4 && previous == -1; dir++){
+            int neighbour = maze.Neighbour(current, dir);
+            if ((open & (1 << dir)) && g[neighbour] + maze.Weight(current, dir) == g[current]) previous = neighbour;
+        }
+        if (previous == -1) return {};  // Should not happen once the search is consistent
+        current = previous;
+        path.push_back(maze.CellAt(current));
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
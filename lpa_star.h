@@ -0,0 +1,34 @@
+#pragma once
+#include "maze.h"
+
+#include <queue>
+#include <utility>
+#include <vector>
+
+/// @brief Lifelong Planning A* (LPA*) between maze.start and maze.finish.
+/// The search state survives between queries; after walls change, only cells whose
+/// distance is affected are re-expanded. Call PassageChanged for every edited passage.
+class LpaStar {
+public:
+    explicit LpaStar(Maze& maze);
+
+    void PassageChanged(const Cell* a, const Cell* b);
+    std::vector<Cell *> Solve();
+
+    int LastExpansions() const {return last_expansions;}
+
+private:
+    using Key = std::pair<int, int>;
+
+    Key CalculateKey(int cell) const;
+    int Heuristic(int cell) const;
+    void UpdateCell(int cell);
+    void ComputeShortestPath();
+
+    Maze& maze;
+    int start, finish;
+    std::vector<int> g;
+    std::vector<int> rhs;
+    std::priority_queue<std::pair<Key, int>, std::vector<std::pair<Key, int>>, std::greater<std::pair<Key, int>>> open_set;
+    int last_expansions = 0;
+};
@@ -3,6 +3,9 @@
 #include "maze.h"
 #include "maze_generator.h"
 #include "webgui.h"
+#include "mpi_controller.h"
+#include "solve_planner.h"
+#include "verify.h"
 #ifdef USE_MPI
 #include "mpi.h"
 #endif
@@ -11,25 +14,78 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <cstdlib>
+#include <cstring>
 #include <omp.h>
 
+static bool verify = false;
+static VerifyOptions verify_options;
+
+/// @brief Apply `--threads N` (OpenMP threads per process, default OMP_NUM_THREADS or all cores).
+/// `--verify` runs the regression check instead of the server, with `--baseline FILE`, `--save-baseline`,
+/// `--tolerance F`, `--repeats N` and `--plan-factor F` (see verify.h).
+static void ParseArguments(int argc, char** argv){
+    for (int i = 1; i < argc; i++){
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc){
+            int threads = std::atoi(argv[++i]);
+            if (threads > 0) omp_set_num_threads(threads);
+        } else if (std::strcmp(argv[i], "--verify") == 0){
+            verify = true;
+        } else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc){
+            verify_options.baseline_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--save-baseline") == 0){
+            verify_options.save_baseline = true;
+        } else if (std::strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc){
+            verify_options.tolerance = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--repeats") == 0 && i + 1 < argc){
+            int repeats = std::atoi(argv[++i]);
+            if (repeats > 0) verify_options.repeats = repeats;
+        } else if (std::strcmp(argv[i], "--plan-factor") == 0 && i + 1 < argc){
+            double factor = std::atof(argv[++i]);
+            if (factor > 1) verify_options.plan_factor = factor;
+        }
+    }
+}
+
 int main(int argc, char** argv) {
+    int exit_code = 0;
 #ifdef USE_MPI
-    MPI_Init(&argc, &argv);
+    // Hybrid MPI + OpenMP: every rank runs an OpenMP team, but OpenMP threads never make MPI calls.
+    // SERIALIZED rather than FUNNELED because rank 0 calls MPI from the web server's handler threads (one at a time, under maze_mutex).
+    int provided = 0;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_SERIALIZED, &provided);
+    MpiInitCommandChannel();
+    ParseArguments(argc, argv);
     int rank = 0;
+    int size = 1;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-    if (rank == 0) {
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (provided < MPI_THREAD_SERIALIZED && rank == 0) {
+        printf("Warning: MPI library only provides thread level %d\n", provided);
+    }
+    if (rank == 0) printf("%d rank(s) x %d thread(s)\n", size, omp_get_max_threads());
+    CalibrateSolvePlanner();
+    if (verify) {
+        exit_code = RunVerification(verify_options);
+    } else if (rank == 0) {
         StartWebServer();
     } else {
         RunMpiWorkerLoop();
     }
 #else
-    StartWebServer();
+    ParseArguments(argc, argv);
+    CalibrateSolvePlanner();
+    if (verify) {
+        exit_code = RunVerification(verify_options);
+    } else {
+        StartWebServer();
+    }
 #endif
 #ifdef USE_MPI
+    MpiFreeCommandChannel();
     MPI_Finalize();
 #endif
-    return 0;
+    return exit_code;
 }
 
 
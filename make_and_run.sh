@@ -2,4 +2,10 @@ make clean
 make maze_mpi
 echo "Build Complete..."
 MPI_NP=${MPI_NP:-6}
-mpirun -np "$MPI_NP" ./maze_mpi
\ No newline at end of file
+THREADS_PER_RANK=${THREADS_PER_RANK:-1}
+if [ -n "$RANKS_PER_NODE" ]; then
+    # Hybrid layout: RANKS_PER_NODE ranks on each node, each bound to THREADS_PER_RANK cores
+    mpirun -np "$MPI_NP" --map-by "ppr:$RANKS_PER_NODE:node:PE=$THREADS_PER_RANK" -x OMP_NUM_THREADS="$THREADS_PER_RANK" ./maze_mpi --threads "$THREADS_PER_RANK"
+else
+    mpirun -np "$MPI_NP" -x OMP_NUM_THREADS="$THREADS_PER_RANK" ./maze_mpi --threads "$THREADS_PER_RANK"
+fi
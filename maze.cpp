@@ -3,6 +3,7 @@
 #include <vector>
 #include <random>
 #include <iostream>
+#include <stdexcept>
 
 Cell::Cell(int posX, int posY)
     : posX(posX), posY(posY), inMaze(false), inFrontier(false) {}
@@ -13,7 +14,7 @@ Passage::Passage(Cell *c1, Cell *c2)
     : c1(c1), c2(c2) {}
 
 Maze::Maze(int sizeX, int sizeY)
-: sizeX(sizeX), sizeY(sizeY), start(NULL), finish(NULL)
+: start(NULL), finish(NULL), sizeX(sizeX), sizeY(sizeY)
 {
     MakeGrid();
 }
@@ -28,11 +29,95 @@ void Maze::MakeGrid()
             cells[y].emplace_back(x, y);
         }
     }
+    open_sides.assign(sizeX * sizeY, 0);
+}
+
+/// @brief Side of a that faces its neighbour b, 0 if they are not adjacent
+static uint8_t SideTowards(const Cell *a, const Cell *b)
+{
+    int dx = b->posX - a->posX;
+    int dy = b->posY - a->posY;
+    if (dx == 1 && dy == 0) return SIDE_EAST;
+    if (dx == 0 && dy == 1) return SIDE_SOUTH;
+    if (dx == -1 && dy == 0) return SIDE_WEST;
+    if (dx == 0 && dy == -1) return SIDE_NORTH;
+    return 0;
 }
 
 void Maze::MakePassage(Cell *a, Cell *b)
 {
     passages.emplace_back(a, b);
+    junction_graph.reset();
+    hpa_graph.reset();
+    wall_bitboard.reset();
+    open_sides[Index(a)] |= SideTowards(a, b);
+    open_sides[Index(b)] |= SideTowards(b, a);
+}
+
+/// @brief Remove the passage between two cells (order does not matter)
+/// @return True if there was a passage to remove
+bool Maze::RemovePassage(Cell *a, Cell *b)
+{
+    for (size_t i = 0; i < passages.size(); i++)
+    {
+        Passage &p = passages[i];
+        if ((p.c1 == a && p.c2 == b) || (p.c1 == b && p.c2 == a))
+        {
+            p = passages.back();
+            passages.pop_back();
+            junction_graph.reset();
+            hpa_graph.reset();
+            wall_bitboard.reset();
+            open_sides[Index(a)] &= ~SideTowards(a, b);
+            open_sides[Index(b)] &= ~SideTowards(b, a);
+            return true;
+        }
+    }
+    return false;
+}
+
+/// @brief Open or close the wall between two adjacent cells
+/// @return True if the maze changed
+bool Maze::SetWall(Cell *a, Cell *b, bool open)
+{
+    if (!SideTowards(a, b) || HasPassage(a, b) == open) return false;
+    if (open)
+    {
+        MakePassage(a, b);
+        return true;
+    }
+    return RemovePassage(a, b);
+}
+
+bool Maze::HasPassage(const Cell *a, const Cell *b) const
+{
+    uint8_t side = SideTowards(a, b);
+    return side && (open_sides[Index(a)] & side);
+}
+
+/// @brief Cost of the step from a to its neighbour b (either direction), 1 if the maze is unweighted
+int Maze::Weight(const Cell *a, const Cell *b) const
+{
+    uint8_t side = SideTowards(a, b);
+    if (!side) throw std::invalid_argument("Cells are not adjacent");
+    return Weight(Index(a), __builtin_ctz(side));
+}
+
+/// @brief Set the cost of side (1 << dir) of a cell, whether or not there is a passage. Weights are 1 to 255;
+/// keeping them at least 1 keeps the Manhattan heuristic admissible.
+void Maze::SetWeight(int index, int dir, int weight)
+{
+    if (weight < 1 || weight > 255) throw std::invalid_argument("Passage weight must be between 1 and 255");
+    if (side_weights.empty())
+    {
+        if (weight == 1) return;
+        side_weights.assign(sizeX * sizeY * 2, 1);
+    }
+    int slot = dir < 2 ? index * 2 + dir : Neighbour(index, dir) * 2 + dir - 2;
+    side_weights[slot] = (uint8_t)weight;
+    junction_graph.reset();
+    hpa_graph.reset();
+    wall_bitboard.reset();
 }
 
 /// @brief Print maze to console (don't use this)
@@ -1,7 +1,21 @@
 #pragma once
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <random>
 
+class JunctionGraph;
+class HpaGraph;
+struct WallBitboard;
+
+/// @brief Bit flags for the open sides of a cell, in the same order as dirX/dirY (east, south, west, north)
+enum Side : uint8_t {
+    SIDE_EAST = 1,
+    SIDE_SOUTH = 2,
+    SIDE_WEST = 4,
+    SIDE_NORTH = 8,
+};
+
 /// @brief A Cell is any position in the maze.
 /// By default, there are walls between every Cell
 class Cell {
@@ -39,12 +53,40 @@ public:
     std::vector<Passage> passages;
 
     void MakePassage(Cell* a, Cell* b);
+    bool RemovePassage(Cell* a, Cell* b);
+    bool SetWall(Cell* a, Cell* b, bool open);
+    bool HasPassage(const Cell* a, const Cell* b) const;
     void MakeGrid();
 
+    int Index(const Cell* c) const {return c->posY * sizeX + c->posX;}
+    Cell* CellAt(int index) {return &cells[index / sizeX][index % sizeX];}
+    uint8_t OpenSides(int index) const {return open_sides[index];}
+    // Index of the neighbour through side (1 << dir). Only valid if that side is open.
+    int Neighbour(int index, int dir) const {
+        static const int step_x[4] = { 1, 0, -1, 0 };
+        static const int step_y[4] = { 0, 1,  0, -1 };
+        return index + step_y[dir] * sizeX + step_x[dir];
+    }
+    // Cost of stepping through side (1 << dir) of the cell (terrain). Every side costs 1 unless weights were set.
+    int Weight(int index, int dir) const {
+        if (side_weights.empty()) return 1;
+        return dir < 2 ? side_weights[index * 2 + dir] : side_weights[Neighbour(index, dir) * 2 + dir - 2];
+    }
+    int Weight(const Cell* a, const Cell* b) const;
+    void SetWeight(int index, int dir, int weight);
+    bool Weighted() const {return !side_weights.empty();}
+
     Cell *start;
     Cell *finish;
+
+    // Solver caches, reset whenever passages or weights change
+    std::shared_ptr<const JunctionGraph> junction_graph;
+    std::shared_ptr<const HpaGraph> hpa_graph;
+    std::shared_ptr<const WallBitboard> wall_bitboard;
 private:
     int sizeX, sizeY;
+    std::vector<uint8_t> open_sides;    // Side flags per cell index, kept in sync with passages
+    std::vector<uint8_t> side_weights;  // Weight of the east and south side per cell index (index * 2 + dir), empty if all are 1
 };
 
 void PrintAsciiMaze(const Maze& maze);
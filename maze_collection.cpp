@@ -0,0 +1,138 @@
+#include "maze_collection.h"
+#include "maze.h"
+#include "maze_generator.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+// Cells per page: small mazes are grouped so batch solvers (lanes) get full batches, big mazes get a page each
+static const int PAGE_CELLS = 64 * 20 * 20;
+
+static const int edit_dx[4] = { 1, 0, -1, 0 };
+static const int edit_dy[4] = { 0, 1,  0, -1 };
+
+void MazeCollection::Reset(int width, int height, int num_mazes, uint32_t batch_seed, const MazeOptions& maze_options, size_t cache_cells){
+    maze_width = width;
+    maze_height = height;
+    count = num_mazes;
+    seed = batch_seed;
+    options = maze_options;
+    page_size = std::max(1, std::min(64, PAGE_CELLS / std::max(1, width * height)));
+    size_t page_cells = (size_t)page_size * width * height;
+    max_cached_pages = std::max<size_t>(2, cache_cells / std::max<size_t>(1, page_cells));
+
+    cache.clear();
+    alive.assign(NumPages(), {});
+    edits.assign(count, {});
+    generation_ms = 0;
+}
+
+int MazeCollection::PageEnd(int page) const {
+    return std::min(count, (page + 1) * page_size);
+}
+
+/// @brief Build a page from the seeds and replay its edit log
+MazeCollection::Page MazeCollection::Materialize(int page){
+    TraceSpan span("generate", page);
+    auto t0 = std::chrono::high_resolution_clock::now();
+    Page mazes = std::make_shared<std::vector<Maze>>();
+    mazes->reserve(PageEnd(page) - PageBegin(page));
+    MazeGenerator generator;
+    for (int i = PageBegin(page); i < PageEnd(page); i++){
+        generator.Seed(seed, i);
+        mazes->emplace_back(maze_width, maze_height);
+        Maze& maze = mazes->back();
+        generator.Generate(maze, options);
+        for (const WallEdit& edit : edits[i]){
+            maze.SetWall(&maze.cells[edit.y][edit.x], &maze.cells[edit.y + edit_dy[edit.dir]][edit.x + edit_dx[edit.dir]], edit.open);
+        }
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    generation_ms += std::chrono::duration<double, std::milli>(t1 - t0).count();
+    return mazes;
+}
+
+void MazeCollection::Touch(int page, const Page& mazes){
+    auto it = std::find_if(cache.begin(), cache.end(), [&](const auto& entry){ return entry.first == page; });
+    if (it != cache.end()){
+        cache.splice(cache.begin(), cache, it);
+        return;
+    }
+    cache.emplace_front(page, mazes);
+    while (cache.size() > max_cached_pages) cache.pop_back();
+}
+
+/// @brief Page of mazes [PageBegin(page), PageEnd(page)), built if it is neither cached nor still held elsewhere
+MazeCollection::Page MazeCollection::GetPage(int page){
+    if (page < 0 || page >= NumPages()) throw std::out_of_range("Maze page out of range");
+    Page mazes = alive[page].lock();
+    if (!mazes){
+        mazes = Materialize(page);
+        alive[page] = mazes;
+    }
+    Touch(page, mazes);
+    return mazes;
+}
+
+/// @brief One maze. The pointer keeps its page alive, so the maze stays the same object while it is held.
+std::shared_ptr<Maze> MazeCollection::Get(int index){
+    if (index < 0 || index >= count) throw std::out_of_range("Maze index out of range");
+    Page mazes = GetPage(index / page_size);
+    return std::shared_ptr<Maze>(mazes, &(*mazes)[index % page_size]);
+}
+
+/// @brief Open or close a wall of maze `index` and log the edit for later rebuilds. Arguments must be valid.
+/// @return True if the wall changed
+bool MazeCollection::SetWall(int index, int x, int y, int dir, bool open){
+    std::shared_ptr<Maze> maze = Get(index);
+    Cell* a = &maze->cells[y][x];
+    Cell* b = &maze->cells[y + edit_dy[dir]][x + edit_dx[dir]];
+    if (!maze->SetWall(a, b, open)) return false;
+    edits[index].push_back({x, y, dir, open});
+    return true;
+}
+
+/// @brief Build the next page of mazes [begin, end) that is not materialized yet, e.g. while an MPI worker waits
+/// for a command. Only the first pages of the range that fit in the cache are built, later ones would evict them.
+/// @return True if a page was built, false if there is nothing left to do
+bool MazeCollection::Prefetch(int begin, int end){
+    if (begin >= end) return false;
+    int first = begin / page_size;
+    int last = std::min((end - 1) / page_size, first + (int)max_cached_pages - 1);
+    for (int page = first; page <= last; page++){
+        if (!alive[page].expired()) continue;
+        GetPage(page);
+        return true;
+    }
+    return false;
+}
+
+/// @brief Number of mazes in [begin, end) whose page is materialized, so using them needs no generation
+int MazeCollection::CachedMazes(int begin, int end) const {
+    int cached = 0;
+    for (int page = begin / page_size; page < NumPages() && PageBegin(page) < end; page++){
+        if (alive[page].expired()) continue;
+        cached += std::min(end, PageEnd(page)) - std::max(begin, PageBegin(page));
+    }
+    return cached;
+}
+
+/// @brief Call fn for every page overlapping mazes [begin, end), with the overlap as page-local indices.
+/// Pages are fetched one at a time, so only the cache bound worth of mazes is materialized at once.
+void MazeCollection::ForEachPage(int begin, int end, const std::function<void(std::vector<Maze>& page, int page_begin, int local_begin, int local_end)>& fn){
+    for (int page = begin / page_size; page < NumPages() && PageBegin(page) < end; page++){
+        Page mazes = GetPage(page);
+        int page_begin = PageBegin(page);
+        fn(*mazes, page_begin, std::max(begin, page_begin) - page_begin, std::min(end, PageEnd(page)) - page_begin);
+    }
+}
+
+/// @brief Time spent generating mazes since the last call
+double MazeCollection::TakeGenerationMs(){
+    double ms = generation_ms;
+    generation_ms = 0;
+    return ms;
+}
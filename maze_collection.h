@@ -0,0 +1,64 @@
+#pragma once
+#include "maze.h"
+#include "maze_generator.h"
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <vector>
+
+/// @brief A batch of mazes stored as its generation parameters. Maze i is generated from a seed derived from
+/// (seed, i), so any maze can be built on its own, in any order and on any rank. Mazes are materialized on first
+/// access in pages of consecutive mazes; at most `cache_cells` cells worth of pages stay cached (least recently
+/// used pages are dropped). Wall edits are logged and replayed when an evicted page is built again.
+/// Not thread-safe, callers serialize access (the web server holds maze_mutex).
+class MazeCollection {
+public:
+    using Page = std::shared_ptr<std::vector<Maze>>;
+
+    static const size_t DEFAULT_CACHE_CELLS = 4 << 20;
+
+    void Reset(int width, int height, int count, uint32_t seed, const MazeOptions& options = MazeOptions(), size_t cache_cells = DEFAULT_CACHE_CELLS);
+
+    int size() const {return count;}
+    bool empty() const {return count == 0;}
+    int width() const {return maze_width;}
+    int height() const {return maze_height;}
+    const MazeOptions& Options() const {return options;}
+    int PageSize() const {return page_size;}
+    int MaxCachedPages() const {return (int)max_cached_pages;}
+    int NumPages() const {return (count + page_size - 1) / page_size;}
+    int PageBegin(int page) const {return page * page_size;}
+    int PageEnd(int page) const;
+
+    Page GetPage(int page);
+    std::shared_ptr<Maze> Get(int index);
+    bool SetWall(int index, int x, int y, int dir, bool open);
+    bool Prefetch(int begin, int end);
+    int CachedMazes(int begin, int end) const;
+    void ForEachPage(int begin, int end, const std::function<void(std::vector<Maze>& page, int page_begin, int local_begin, int local_end)>& fn);
+    double TakeGenerationMs();
+
+private:
+    struct WallEdit {
+        int x, y, dir;
+        bool open;
+    };
+
+    Page Materialize(int page);
+    void Touch(int page, const Page& mazes);
+
+    int maze_width = 0;
+    int maze_height = 0;
+    int count = 0;
+    uint32_t seed = 0;
+    MazeOptions options;
+    int page_size = 1;
+    size_t max_cached_pages = 1;
+
+    std::list<std::pair<int, Page>> cache;      // Most recently used first
+    std::vector<std::weak_ptr<std::vector<Maze>>> alive;   // Pages still held by someone, reused instead of rebuilt
+    std::vector<std::vector<WallEdit>> edits;   // Edit log per maze
+    double generation_ms = 0;
+};
@@ -2,6 +2,8 @@
 #include "maze.h"
 #include <stdexcept>
 #include <random>
+#include <algorithm>
+#include <vector>
 
 static const int dirX[4] = { 1, 0, -1, 0 };
 static const int dirY[4] = { 0, 1,  0, -1 };
@@ -17,6 +19,21 @@ void MazeGenerator::Seed(uint32_t seed)
     rng.seed(seed);
 }
 
+/// @brief Seed an independent stream per (seed, stream) pair, e.g. one per maze of a batch
+void MazeGenerator::Seed(uint32_t seed, uint32_t stream)
+{
+    std::seed_seq sequence{ seed, stream };
+    rng.seed(sequence);
+}
+
+/// @brief Generate a perfect maze with Prim's algorithm, then braid and weight it as the options say
+void MazeGenerator::Generate(Maze &maze, const MazeOptions &options)
+{
+    GeneratePrim(maze);
+    if (options.braid > 0) Braid(maze, options.braid);
+    if (options.max_weight > 1) AssignWeights(maze, options.max_weight);
+}
+
 /// @brief Generate maze with prim's algorithm https://weblog.jamisbuck.org/2011/1/10/maze-generation-prim-s-algorithm
 /// @param maze Empty maze with cells. The function will fill this maze with passages, start and finish.
 void MazeGenerator::GeneratePrim(Maze &maze)
@@ -86,6 +103,59 @@ void MazeGenerator::GeneratePrim(Maze &maze)
     maze.finish = lastVisited;
 }
 
+/// @brief Remove dead ends by opening one of their walls, which creates loops ("braiding").
+/// Dead ends are visited in random order; a wall towards another dead end is preferred, so one opening can remove two.
+/// @param braid Fraction of dead ends to remove, from 0 (perfect maze) to 1 (no dead ends)
+void MazeGenerator::Braid(Maze &maze, double braid)
+{
+    int num_cells = maze.width() * maze.height();
+    std::vector<int> dead_ends;
+    for (int c = 0; c < num_cells; c++)
+    {
+        if (__builtin_popcount(maze.OpenSides(c)) == 1) dead_ends.push_back(c);
+    }
+    std::shuffle(dead_ends.begin(), dead_ends.end(), rng);
+
+    std::bernoulli_distribution remove(std::min(1.0, braid));
+    for (int c : dead_ends)
+    {
+        if (__builtin_popcount(maze.OpenSides(c)) != 1 || !remove(rng)) continue;   // Already opened by a neighbour
+
+        int x = c % maze.width();
+        int y = c / maze.width();
+        std::vector<int> walls, dead_end_walls;
+        for (int dir = 0; dir < 4; dir++)
+        {
+            int nx = x + dirX[dir];
+            int ny = y + dirY[dir];
+            if (nx < 0 || nx >= maze.width() || ny < 0 || ny >= maze.height() || (maze.OpenSides(c) & (1 << dir)))
+                continue;
+            walls.push_back(dir);
+            if (__builtin_popcount(maze.OpenSides(ny * maze.width() + nx)) == 1) dead_end_walls.push_back(dir);
+        }
+        const std::vector<int> &choices = dead_end_walls.empty() ? walls : dead_end_walls;
+        if (choices.empty()) continue;
+        std::uniform_int_distribution<int> pick(0, (int)choices.size() - 1);
+        int dir = choices[pick(rng)];
+        maze.MakePassage(&maze.cells[y][x], &maze.cells[y + dirY[dir]][x + dirX[dir]]);
+    }
+}
+
+/// @brief Give every side between two cells a random cost (terrain), uniform in [1, max_weight]
+void MazeGenerator::AssignWeights(Maze &maze, int max_weight)
+{
+    std::uniform_int_distribution<int> weight(1, std::min(255, max_weight));
+    for (int y = 0; y < maze.height(); y++)
+    {
+        for (int x = 0; x < maze.width(); x++)
+        {
+            int c = y * maze.width() + x;
+            if (x + 1 < maze.width()) maze.SetWeight(c, 0, weight(rng));
+            if (y + 1 < maze.height()) maze.SetWeight(c, 1, weight(rng));
+        }
+    }
+}
+
 /// @brief Finds the four neighbours of the current cell
 /// @param c Current Cell
 void MazeGenerator::AddFrontierNeighbours(Maze &maze, std::vector<Cell*> &frontier, Cell* c)
@@ -3,11 +3,21 @@
 #include <vector>
 #include <random>
 
+/// @brief Changes applied on top of the perfect maze from GeneratePrim
+struct MazeOptions {
+    double braid = 0;       // Fraction of dead ends opened into loops, 0 keeps the maze perfect
+    int max_weight = 1;     // Passage weights are drawn from [1, max_weight], 1 keeps the maze unweighted
+};
+
 class MazeGenerator{
 public:
     MazeGenerator();
     void Seed(uint32_t seed);
+    void Seed(uint32_t seed, uint32_t stream);
+    void Generate(Maze& maze, const MazeOptions& options);
     void GeneratePrim(Maze& maze);
+    void Braid(Maze& maze, double braid);
+    void AssignWeights(Maze& maze, int max_weight);
 
 private:
     std::mt19937 rng;
@@ -0,0 +1,82 @@
+#include "maze_tiles.h"
+#include "maze.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Per-cell path marks: the cell itself, and the steps through its east and south sides
+static const uint8_t PATH_CELL = 1;
+static const uint8_t PATH_EAST = 2;
+static const uint8_t PATH_SOUTH = 4;
+
+/// @brief Render one tile of the maze's wall grid as a packed bitmap, 4 pixels per byte (lowest bits first),
+/// rows of TILE_SIZE pixels. At zoom z a pixel covers 2^z x 2^z grid pixels: it is path if any of them is,
+/// otherwise wall if most of them are. Pixels past the maze are TILE_OUTSIDE.
+/// @param path Cell indices of the solved path (may be empty), drawn as TILE_PATH
+/// @return TILE_SIZE * TILE_SIZE / 4 bytes
+std::string RenderTile(const Maze& maze, const int32_t* path, size_t path_length, int tile_x, int tile_y, int zoom){
+    int width = maze.width();
+    int grid_w = 2 * width + 1;
+    int grid_h = 2 * maze.height() + 1;
+    int scale = 1 << std::max(0, std::min(MAX_TILE_ZOOM, zoom));
+
+    std::vector<uint8_t> on_path;
+    if (path_length > 0){
+        on_path.assign(width * maze.height(), 0);
+        for (size_t i = 0; i < path_length; i++){
+            on_path[path[i]] |= PATH_CELL;
+            if (i == 0) continue;
+            int a = std::min(path[i - 1], path[i]);
+            int b = std::max(path[i - 1], path[i]);
+            on_path[a] |= (b == a + 1) ? PATH_EAST : PATH_SOUTH;
+        }
+    }
+    auto path_mark = [&](int cell, uint8_t mark){
+        return !on_path.empty() && (on_path[cell] & mark);
+    };
+
+    auto grid_pixel = [&](int gx, int gy) -> uint8_t {
+        bool odd_x = gx & 1;
+        bool odd_y = gy & 1;
+        if (odd_x && odd_y) return path_mark((gy / 2) * width + gx / 2, PATH_CELL) ? TILE_PATH : TILE_FLOOR;
+        if (!odd_x && !odd_y) return TILE_WALL;
+        if (odd_x){
+            // Between (gx / 2, gy / 2 - 1) and the cell below it
+            if (gy == 0 || gy == grid_h - 1) return TILE_WALL;
+            int cell = (gy / 2 - 1) * width + gx / 2;
+            if (!(maze.OpenSides(cell) & SIDE_SOUTH)) return TILE_WALL;
+            return path_mark(cell, PATH_SOUTH) ? TILE_PATH : TILE_FLOOR;
+        }
+        // Between (gx / 2 - 1, gy / 2) and the cell right of it
+        if (gx == 0 || gx == grid_w - 1) return TILE_WALL;
+        int cell = (gy / 2) * width + gx / 2 - 1;
+        if (!(maze.OpenSides(cell) & SIDE_EAST)) return TILE_WALL;
+        return path_mark(cell, PATH_EAST) ? TILE_PATH : TILE_FLOOR;
+    };
+
+    std::string tile(TILE_SIZE * TILE_SIZE / 4, 0);
+    for (int py = 0; py < TILE_SIZE; py++){
+        long y0 = ((long)tile_y * TILE_SIZE + py) * scale;
+        for (int px = 0; px < TILE_SIZE; px++){
+            long x0 = ((long)tile_x * TILE_SIZE + px) * scale;
+            uint8_t value = TILE_OUTSIDE;
+            if (x0 >= 0 && y0 >= 0 && x0 < grid_w && y0 < grid_h){
+                int inside = 0;
+                int walls = 0;
+                bool on_route = false;
+                for (int gy = y0; gy < std::min<long>(grid_h, y0 + scale); gy++){
+                    for (int gx = x0; gx < std::min<long>(grid_w, x0 + scale); gx++){
+                        uint8_t pixel = grid_pixel(gx, gy);
+                        inside++;
+                        walls += pixel == TILE_WALL;
+                        on_route |= pixel == TILE_PATH;
+                    }
+                }
+                value = on_route ? TILE_PATH : (walls * 2 > inside ? TILE_WALL : TILE_FLOOR);
+            }
+            tile[(py * TILE_SIZE + px) / 4] |= value << (2 * (px % 4));
+        }
+    }
+    return tile;
+}
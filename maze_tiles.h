@@ -0,0 +1,21 @@
+#pragma once
+#include "maze.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Tiles are TILE_SIZE x TILE_SIZE pixels of the wall grid, the (2 * width + 1) x (2 * height + 1) raster in which
+// odd/odd pixels are cells, even/even pixels are wall corners and the rest are walls or openings between cells
+static const int TILE_SIZE = 256;
+static const int MAX_TILE_ZOOM = 8;
+
+// Pixel values, 2 bits each
+enum TilePixel : uint8_t {
+    TILE_FLOOR = 0,
+    TILE_WALL = 1,
+    TILE_PATH = 2,
+    TILE_OUTSIDE = 3,
+};
+
+std::string RenderTile(const Maze& maze, const int32_t* path, size_t path_length, int tile_x, int tile_y, int zoom);
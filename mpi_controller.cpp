@@ -1,14 +1,22 @@
 #include "mpi_controller.h"
+#include "search_heuristic.h"
 
 #ifdef USE_MPI
 #include "mpi.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <stdexcept>
+#include <thread>
+#include <type_traits>
 
 enum class WorkerCommand : int {
     Generate = 1,
     Solve = 2,
     Shutdown = 3,
+    Trace = 4,
+    EditWall = 5,
 };
 
 enum class SolveModeCode : int {
@@ -16,12 +24,14 @@ enum class SolveModeCode : int {
     Intra = 2,
     Combined = 3,
     Sequential = 4,
+    Auto = 5,
 };
 
 static SolveModeCode ModeToCode(const std::string& mode) {
     if (mode == "inter") return SolveModeCode::Inter;
     if (mode == "intra") return SolveModeCode::Intra;
     if (mode == "combined") return SolveModeCode::Combined;
+    if (mode == "auto") return SolveModeCode::Auto;
     return SolveModeCode::Sequential;
 }
 
@@ -29,45 +39,180 @@ static std::string CodeToMode(SolveModeCode mode) {
     if (mode == SolveModeCode::Inter) return "inter";
     if (mode == SolveModeCode::Intra) return "intra";
     if (mode == SolveModeCode::Combined) return "combined";
+    if (mode == SolveModeCode::Auto) return "auto";
     return "sequential";
 }
 
-void MpiBroadcastGenerateCommand(int width, int height, int num_mazes, uint32_t seed) {
-    int cmd = static_cast<int>(WorkerCommand::Generate);
-    int payload[3] = {width, height, num_mazes};
-    unsigned long long seed_payload = static_cast<unsigned long long>(seed);
-    MPI_Bcast(&cmd, 1, MPI_INT, 0, MPI_COMM_WORLD);
-    MPI_Bcast(payload, 3, MPI_INT, 0, MPI_COMM_WORLD);
-    MPI_Bcast(&seed_payload, 1, MPI_UNSIGNED_LONG_LONG, 0, MPI_COMM_WORLD);
+enum class AlgorithmCode : int {
+    AStar = 1,
+    Bidirectional = 2,
+    BidirectionalParallel = 3,
+    Junction = 4,
+    Hpa = 5,
+    Bitboard = 6,
+    Lanes = 7,
+};
+
+static AlgorithmCode AlgorithmToCode(const std::string& algorithm) {
+    if (algorithm == "bidir") return AlgorithmCode::Bidirectional;
+    if (algorithm == "bidir_par") return AlgorithmCode::BidirectionalParallel;
+    if (algorithm == "junction") return AlgorithmCode::Junction;
+    if (algorithm == "hpa") return AlgorithmCode::Hpa;
+    if (algorithm == "bitboard") return AlgorithmCode::Bitboard;
+    if (algorithm == "lanes") return AlgorithmCode::Lanes;
+    return AlgorithmCode::AStar;
+}
+
+static std::string CodeToAlgorithm(AlgorithmCode algorithm) {
+    if (algorithm == AlgorithmCode::Bidirectional) return "bidir";
+    if (algorithm == AlgorithmCode::BidirectionalParallel) return "bidir_par";
+    if (algorithm == AlgorithmCode::Junction) return "junction";
+    if (algorithm == AlgorithmCode::Hpa) return "hpa";
+    if (algorithm == AlgorithmCode::Bitboard) return "bitboard";
+    if (algorithm == AlgorithmCode::Lanes) return "lanes";
+    return "astar";
+}
+
+/// @brief Every command is one fixed-size packet, broadcast in a single MPI_Ibcast. Bump COMMAND_VERSION whenever the
+/// layout or the meaning of a field changes, so mismatched binaries fail loudly instead of misreading payloads.
+static const int32_t COMMAND_VERSION = 4;
+
+struct CommandPacket {
+    int32_t version = COMMAND_VERSION;
+    int32_t command = 0;
+    int32_t args[6] = {0, 0, 0, 0, 0, 0};
+    uint64_t seed = 0;
+    double real = 0;
+};
+static_assert(std::is_trivially_copyable<CommandPacket>::value, "CommandPacket is sent as raw bytes");
+
+// Commands travel on their own communicator, so a pending command broadcast never matches a solver collective
+static MPI_Comm command_comm = MPI_COMM_NULL;
+
+// Workers poll the pending broadcast; while idle without background work they back off up to this long
+static const int MAX_IDLE_SLEEP_US = 1000;
+
+/// @brief Create the command channel. Collective, call on every rank right after MPI_Init.
+void MpiInitCommandChannel() {
+    MPI_Comm_dup(MPI_COMM_WORLD, &command_comm);
+}
+
+/// @brief Free the command channel. Collective, call on every rank before MPI_Finalize.
+void MpiFreeCommandChannel() {
+    if (command_comm != MPI_COMM_NULL) MPI_Comm_free(&command_comm);
+}
+
+static void SendCommand(CommandPacket& packet) {
+    MPI_Request request;
+    MPI_Ibcast(&packet, sizeof(packet), MPI_BYTE, 0, command_comm, &request);
+    MPI_Wait(&request, MPI_STATUS_IGNORE);
+}
+
+void MpiBroadcastGenerateCommand(int width, int height, int num_mazes, uint32_t seed, const MazeOptions& options) {
+    CommandPacket packet;
+    packet.command = static_cast<int32_t>(WorkerCommand::Generate);
+    packet.args[0] = width;
+    packet.args[1] = height;
+    packet.args[2] = num_mazes;
+    packet.args[3] = options.max_weight;
+    packet.seed = seed;
+    packet.real = options.braid;
+    SendCommand(packet);
 }
 
-void MpiBroadcastSolveCommand(const std::string& mode) {
-    int cmd = static_cast<int>(WorkerCommand::Solve);
-    int mode_code = static_cast<int>(ModeToCode(mode));
-    MPI_Bcast(&cmd, 1, MPI_INT, 0, MPI_COMM_WORLD);
-    MPI_Bcast(&mode_code, 1, MPI_INT, 0, MPI_COMM_WORLD);
+void MpiBroadcastSolveCommand(const std::string& mode, const std::string& algorithm, const std::string& heuristic) {
+    SearchHeuristic heuristic_code = SearchHeuristic::Manhattan;
+    ParseHeuristic(heuristic, heuristic_code);
+    CommandPacket packet;
+    packet.command = static_cast<int32_t>(WorkerCommand::Solve);
+    packet.args[0] = static_cast<int32_t>(ModeToCode(mode));
+    packet.args[1] = static_cast<int32_t>(AlgorithmToCode(algorithm));
+    packet.args[2] = static_cast<int32_t>(heuristic_code);
+    SendCommand(packet);
 }
 
-void MpiRunWorkerLoop(const std::function<void(int, int, int, uint32_t)>& onGenerate,
-                      const std::function<void(const std::string&)>& onSolve) {
+/// @brief Broadcast a trace operation (see TraceOp in webgui.cpp). Rank 0 must perform the same operation after this call.
+void MpiBroadcastTraceCommand(int trace_op) {
+    CommandPacket packet;
+    packet.command = static_cast<int32_t>(WorkerCommand::Trace);
+    packet.args[0] = trace_op;
+    SendCommand(packet);
+}
+
+/// @brief Broadcast a wall edit so every rank keeps an identical copy of the maze
+void MpiBroadcastEditCommand(int maze_idx, int x, int y, int dir, bool open) {
+    CommandPacket packet;
+    packet.command = static_cast<int32_t>(WorkerCommand::EditWall);
+    packet.args[0] = maze_idx;
+    packet.args[1] = x;
+    packet.args[2] = y;
+    packet.args[3] = dir;
+    packet.args[4] = open ? 1 : 0;
+    SendCommand(packet);
+}
+
+/// @brief Tell the workers to leave MpiRunWorkerLoop, so every rank can reach MPI_Finalize
+void MpiBroadcastShutdownCommand() {
+    CommandPacket packet;
+    packet.command = static_cast<int32_t>(WorkerCommand::Shutdown);
+    SendCommand(packet);
+}
+
+/// @brief Wait for the next command without blocking: the broadcast is posted with MPI_Ibcast and polled with
+/// MPI_Test. Between polls the worker runs onIdle (background work such as generating its share of the mazes);
+/// when that has nothing to do, the worker sleeps with a growing back-off so an idle rank does not spin.
+static CommandPacket ReceiveCommand(const std::function<bool()>& onIdle) {
+    CommandPacket packet;
+    MPI_Request request;
+    MPI_Ibcast(&packet, sizeof(packet), MPI_BYTE, 0, command_comm, &request);
+    int sleep_us = 0;
+    int done = 0;
+    MPI_Test(&request, &done, MPI_STATUS_IGNORE);
+    while (!done) {
+        if (onIdle && onIdle()) {
+            sleep_us = 0;
+        } else {
+            sleep_us = std::min(MAX_IDLE_SLEEP_US, std::max(10, sleep_us * 2));
+            std::this_thread::sleep_for(std::chrono::microseconds(sleep_us));
+        }
+        MPI_Test(&request, &done, MPI_STATUS_IGNORE);
+    }
+    if (packet.version != COMMAND_VERSION) {
+        throw std::runtime_error("MPI command version mismatch: got " + std::to_string(packet.version) + ", expected " + std::to_string(COMMAND_VERSION));
+    }
+    return packet;
+}
+
+void MpiRunWorkerLoop(const std::function<void(int, int, int, uint32_t, const MazeOptions&)>& onGenerate,
+                      const std::function<void(const std::string&, const std::string&, const std::string&)>& onSolve,
+                      const std::function<void(int)>& onTrace,
+                      const std::function<void(int, int, int, int, bool)>& onEdit,
+                      const std::function<bool()>& onIdle) {
     while (true) {
-        int cmd_int = 0;
-        MPI_Bcast(&cmd_int, 1, MPI_INT, 0, MPI_COMM_WORLD);
-        WorkerCommand cmd = static_cast<WorkerCommand>(cmd_int);
+        CommandPacket packet = ReceiveCommand(onIdle);
+        WorkerCommand cmd = static_cast<WorkerCommand>(packet.command);
 
         if (cmd == WorkerCommand::Generate) {
-            int payload[3] = {0, 0, 0};
-            unsigned long long seed_payload = 0;
-            MPI_Bcast(payload, 3, MPI_INT, 0, MPI_COMM_WORLD);
-            MPI_Bcast(&seed_payload, 1, MPI_UNSIGNED_LONG_LONG, 0, MPI_COMM_WORLD);
-            onGenerate(payload[0], payload[1], payload[2], static_cast<uint32_t>(seed_payload));
+            MazeOptions options;
+            options.max_weight = packet.args[3];
+            options.braid = packet.real;
+            onGenerate(packet.args[0], packet.args[1], packet.args[2], static_cast<uint32_t>(packet.seed), options);
             continue;
         }
 
         if (cmd == WorkerCommand::Solve) {
-            int mode_int = 0;
-            MPI_Bcast(&mode_int, 1, MPI_INT, 0, MPI_COMM_WORLD);
-            onSolve(CodeToMode(static_cast<SolveModeCode>(mode_int)));
+            onSolve(CodeToMode(static_cast<SolveModeCode>(packet.args[0])), CodeToAlgorithm(static_cast<AlgorithmCode>(packet.args[1])),
+                    HeuristicName(static_cast<SearchHeuristic>(packet.args[2])));
+            continue;
+        }
+
+        if (cmd == WorkerCommand::Trace) {
+            onTrace(packet.args[0]);
+            continue;
+        }
+
+        if (cmd == WorkerCommand::EditWall) {
+            onEdit(packet.args[0], packet.args[1], packet.args[2], packet.args[3], packet.args[4] != 0);
             continue;
         }
 
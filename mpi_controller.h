@@ -4,9 +4,19 @@
 #include <functional>
 #include <string>
 
+#include "maze_generator.h"
+
 #ifdef USE_MPI
-void MpiBroadcastGenerateCommand(int width, int height, int num_mazes, uint32_t seed);
-void MpiBroadcastSolveCommand(const std::string& mode);
-void MpiRunWorkerLoop(const std::function<void(int, int, int, uint32_t)>& onGenerate,
-                      const std::function<void(const std::string&)>& onSolve);
+void MpiInitCommandChannel();
+void MpiFreeCommandChannel();
+void MpiBroadcastGenerateCommand(int width, int height, int num_mazes, uint32_t seed, const MazeOptions& options);
+void MpiBroadcastSolveCommand(const std::string& mode, const std::string& algorithm, const std::string& heuristic);
+void MpiBroadcastTraceCommand(int trace_op);
+void MpiBroadcastEditCommand(int maze_idx, int x, int y, int dir, bool open);
+void MpiBroadcastShutdownCommand();
+void MpiRunWorkerLoop(const std::function<void(int, int, int, uint32_t, const MazeOptions&)>& onGenerate,
+                      const std::function<void(const std::string&, const std::string&, const std::string&)>& onSolve,
+                      const std::function<void(int)>& onTrace,
+                      const std::function<void(int, int, int, int, bool)>& onEdit,
+                      const std::function<bool()>& onIdle = nullptr);
 #endif
@@ -0,0 +1,61 @@
+#include "path_codec.h"
+#include "path_set.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+struct CompactPathHeader {
+    int32_t num_cells;
+    int32_t first_cell;
+};
+
+/// @brief Direction from cell a to cell b, which must be neighbours
+static int MoveCode(int width, int32_t a, int32_t b){
+    if (b == a + 1) return 0;
+    if (b == a + width) return 1;
+    if (b == a - 1) return 2;
+    if (b == a - width) return 3;
+    throw std::invalid_argument("Path steps between cells that are not neighbours");
+}
+
+/// @brief Append the compact encoding of one path of `paths` to `buffer`
+void AppendCompactPath(const PathSet& paths, size_t path, std::vector<uint8_t>& buffer){
+    size_t length = paths.Length(path);
+    const int32_t* cells = paths.Cells(path);
+    CompactPathHeader header = { (int32_t)length, length == 0 ? -1 : cells[0] };
+    size_t offset = buffer.size();
+    size_t num_moves = length == 0 ? 0 : length - 1;
+    buffer.resize(offset + sizeof(header) + (num_moves + 3) / 4, 0);
+    std::memcpy(buffer.data() + offset, &header, sizeof(header));
+
+    uint8_t* moves = buffer.data() + offset + sizeof(header);
+    for (size_t i = 0; i < num_moves; i++){
+        moves[i / 4] |= MoveCode(paths.Width(path), cells[i], cells[i + 1]) << (2 * (i % 4));
+    }
+}
+
+/// @brief Decode one path written by AppendCompactPath and append it to `paths`
+/// @param width Width of the maze the path belongs to
+/// @return Number of bytes consumed
+size_t ReadCompactPath(const uint8_t* data, int width, PathSet& paths){
+    CompactPathHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.num_cells <= 0){
+        paths.Append(width, nullptr, 0);
+        return sizeof(header);
+    }
+
+    static const int step_x[4] = { 1, 0, -1, 0 };
+    static const int step_y[4] = { 0, 1,  0, -1 };
+    size_t num_moves = header.num_cells - 1;
+    const uint8_t* moves = data + sizeof(header);
+    std::vector<int32_t> cells(header.num_cells);
+    cells[0] = header.first_cell;
+    for (size_t i = 0; i < num_moves; i++){
+        int dir = (moves[i / 4] >> (2 * (i % 4))) & 3;
+        cells[i + 1] = cells[i] + step_y[dir] * width + step_x[dir];
+    }
+    paths.Append(width, cells.data(), cells.size());
+    return sizeof(header) + (num_moves + 3) / 4;
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include "path_set.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compact path encoding used to ship paths between ranks: a header with the number of cells and the
+// index of the first cell (-1 for an empty path), then one 2-bit move per step (dir numbering of
+// Maze::Neighbour), four moves per byte.
+
+void AppendCompactPath(const PathSet& paths, size_t path, std::vector<uint8_t>& buffer);
+size_t ReadCompactPath(const uint8_t* data, int width, PathSet& paths);
@@ -0,0 +1,42 @@
+#include "path_set.h"
+#include "maze.h"
+
+#include <vector>
+
+void PathSet::Reserve(size_t num_paths, size_t num_cells){
+    cells.reserve(num_cells);
+    offsets.reserve(num_paths + 1);
+    widths.reserve(num_paths);
+}
+
+void PathSet::Append(const Maze& maze, const std::vector<Cell *>& path){
+    for (const Cell* cell : path) cells.push_back(maze.Index(cell));
+    offsets.push_back(cells.size());
+    widths.push_back(maze.width());
+}
+
+void PathSet::Append(int width, const int32_t* path, size_t length){
+    cells.insert(cells.end(), path, path + length);
+    offsets.push_back(cells.size());
+    widths.push_back(width);
+}
+
+/// @brief Append all paths of another set, in order
+void PathSet::Append(const PathSet& other){
+    size_t base = cells.size();
+    cells.insert(cells.end(), other.cells.begin(), other.cells.end());
+    for (size_t i = 1; i < other.offsets.size(); i++) offsets.push_back(base + other.offsets[i]);
+    widths.insert(widths.end(), other.widths.begin(), other.widths.end());
+}
+
+/// @brief Path as Cell pointers into `maze`, for the single-maze APIs
+std::vector<Cell *> PathSet::ToCells(Maze& maze, size_t path) const {
+    std::vector<Cell *> result;
+    result.reserve(Length(path));
+    for (size_t i = 0; i < Length(path); i++) result.push_back(maze.CellAt(Cells(path)[i]));
+    return result;
+}
+
+bool PathSet::operator==(const PathSet& other) const {
+    return widths == other.widths && offsets == other.offsets && cells == other.cells;
+}
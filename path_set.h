@@ -0,0 +1,39 @@
+#pragma once
+#include "maze.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/// @brief Paths of a batch of mazes in one contiguous buffer. Path i is cells [offsets[i], offsets[i + 1]) as
+/// cell indices (y * width + x) of maze i. The width of every maze is kept with its path, so paths can be turned
+/// back into coordinates without the mazes, and they stay valid when mazes are moved. An empty path means no path.
+class PathSet {
+public:
+    size_t size() const {return widths.size();}
+    bool empty() const {return widths.empty();}
+    size_t Length(size_t path) const {return offsets[path + 1] - offsets[path];}
+    const int32_t* Cells(size_t path) const {return cells.data() + offsets[path];}
+    int Width(size_t path) const {return widths[path];}
+    int X(size_t path, size_t step) const {return Cells(path)[step] % widths[path];}
+    int Y(size_t path, size_t step) const {return Cells(path)[step] / widths[path];}
+    size_t TotalCells() const {return cells.size();}
+
+    void Reserve(size_t num_paths, size_t num_cells);
+    void Append(const Maze& maze, const std::vector<Cell *>& path);
+    void Append(int width, const int32_t* path, size_t length);
+    void Append(const PathSet& other);
+    std::vector<Cell *> ToCells(Maze& maze, size_t path) const;
+
+    bool operator==(const PathSet& other) const;
+    bool operator!=(const PathSet& other) const {return !(*this == other);}
+
+private:
+    std::vector<int32_t> cells;
+    std::vector<size_t> offsets = { 0 };
+    std::vector<int32_t> widths;
+};
+
+// Solved paths handed around without copying (e.g. the web server's cached solution)
+using SharedPathSet = std::shared_ptr<const PathSet>;
@@ -0,0 +1,106 @@
+#include "pipeline.h"
+#include "maze.h"
+#include "maze_generator.h"
+#include "jsonifier.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+static double NowMs(){
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+GenerateSolvePipeline::GenerateSolvePipeline(int width, int height, int count, uint32_t seed, const MazeOptions& options, BatchSolver solver, int chunk_size, size_t queue_depth)
+    : width(width), height(height), count(count), seed(seed), options(options), solver(std::move(solver)), chunk_size(std::max(1, chunk_size)),
+      generated(queue_depth), solved(queue_depth), start_time_ms(NowMs()){
+    generate_thread = std::thread(&GenerateSolvePipeline::GenerateStage, this);
+    solve_thread = std::thread(&GenerateSolvePipeline::SolveStage, this);
+}
+
+GenerateSolvePipeline::~GenerateSolvePipeline(){
+    Stop();
+}
+
+/// @brief Abandon the run (e.g. the client went away) and wait for the stage threads
+void GenerateSolvePipeline::Stop(){
+    generated.Close();
+    solved.Close();
+    Join();
+}
+
+void GenerateSolvePipeline::Join(){
+    if (generate_thread.joinable()) generate_thread.join();
+    if (solve_thread.joinable()) solve_thread.join();
+}
+
+void GenerateSolvePipeline::GenerateStage(){
+    MazeGenerator generator;
+    for (int begin = 0; begin < count; begin += chunk_size){
+        double t0 = NowMs();
+        Chunk chunk;
+        chunk.begin = begin;
+        int end = std::min(count, begin + chunk_size);
+        chunk.mazes.reserve(end - begin);
+        {
+            TraceSpan span("generate", begin);
+            for (int i = begin; i < end; i++){
+                generator.Seed(seed, i);
+                chunk.mazes.emplace_back(width, height);
+                generator.Generate(chunk.mazes.back(), options);
+            }
+        }
+        timings.generate_ms += NowMs() - t0;
+        if (!generated.Push(std::move(chunk))) return;
+    }
+    generated.Close();
+}
+
+void GenerateSolvePipeline::SolveStage(){
+    Chunk chunk;
+    while (generated.Pop(chunk)){
+        double t0 = NowMs();
+        {
+            TraceSpan span("solve", chunk.begin);
+            chunk.paths = solver(chunk.mazes, 0, (int)chunk.mazes.size());
+        }
+        timings.solve_ms += NowMs() - t0;
+        if (!solved.Push(std::move(chunk))) return;
+    }
+    solved.Close();
+}
+
+/// @brief Serialize the next piece of output: a header line first, then one line per maze of the next solved
+/// chunk, then a line with the stage timings.
+/// @return False once everything has been returned
+bool GenerateSolvePipeline::Next(std::string& out){
+    if (finished) return false;
+    if (!header_sent){
+        header_sent = true;
+        out = "{\"numMazes\":" + std::to_string(count) + ",\"width\":" + std::to_string(width) + ",\"height\":" + std::to_string(height) + "}\n";
+        return true;
+    }
+
+    Chunk chunk;
+    if (solved.Pop(chunk)){
+        double t0 = NowMs();
+        TraceSpan span("serialize", chunk.begin);
+        std::ostringstream oss;
+        for (size_t i = 0; i < chunk.mazes.size(); i++){
+            oss << MazeResultToJSON(chunk.begin + (int)i, chunk.mazes[i], chunk.paths, i) << "\n";
+        }
+        out = oss.str();
+        timings.serialize_ms += NowMs() - t0;
+        return true;
+    }
+
+    Join();
+    finished = true;
+    timings.total_ms = NowMs() - start_time_ms;
+    std::ostringstream oss;
+    oss << "{\"generationTime\":" << timings.generate_ms << ",\"solvingTime\":" << timings.solve_ms
+        << ",\"serializeTime\":" << timings.serialize_ms << ",\"totalTime\":" << timings.total_ms << "}\n";
+    out = oss.str();
+    return true;
+}
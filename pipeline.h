@@ -0,0 +1,62 @@
+#pragma once
+#include "maze.h"
+#include "path_set.h"
+#include "solve_a_star.h"
+#include "bounded_queue.h"
+#include "maze_generator.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Busy time of every stage, the wall time of a pipelined run approaches the largest one
+struct PipelineTimings {
+    double generate_ms = 0;
+    double solve_ms = 0;
+    double serialize_ms = 0;
+    double total_ms = 0;
+};
+
+/// @brief Generate -> solve -> serialize for one batch, with every stage on its own thread and bounded queues
+/// in between. While chunk i is serialized, chunk i+1 is solved and chunk i+2 generated. Mazes are generated from
+/// the same (seed, index) streams as MazeCollection, so the output matches the collection built with that seed.
+/// The serialize stage runs on the caller's thread: Next returns the batch as newline-delimited JSON, one piece
+/// at a time.
+class GenerateSolvePipeline {
+public:
+    GenerateSolvePipeline(int width, int height, int count, uint32_t seed, const MazeOptions& options, BatchSolver solver, int chunk_size, size_t queue_depth = 4);
+    ~GenerateSolvePipeline();
+
+    bool Next(std::string& out);
+    void Stop();
+    PipelineTimings Timings() const {return timings;}
+
+private:
+    struct Chunk {
+        int begin = 0;
+        std::vector<Maze> mazes;
+        PathSet paths;
+    };
+
+    void GenerateStage();
+    void SolveStage();
+    void Join();
+
+    int width, height, count;
+    uint32_t seed;
+    MazeOptions options;
+    BatchSolver solver;
+    int chunk_size;
+
+    BoundedQueue<Chunk> generated;
+    BoundedQueue<Chunk> solved;
+    std::thread generate_thread;
+    std::thread solve_thread;
+
+    bool header_sent = false;
+    bool finished = false;
+    double start_time_ms;
+    PipelineTimings timings;    // Stage fields are written by their own thread, read after Join
+};
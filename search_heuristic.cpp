@@ -0,0 +1,21 @@
+#include "search_heuristic.h"
+
+/// @brief Map the "heuristic" request parameter (manhattan, octile, euclidean, zero) to a heuristic
+/// @return False if the name is unknown
+bool ParseHeuristic(const std::string &name, SearchHeuristic &heuristic){
+    if (name == "manhattan") heuristic = SearchHeuristic::Manhattan;
+    else if (name == "octile") heuristic = SearchHeuristic::Octile;
+    else if (name == "euclidean") heuristic = SearchHeuristic::Euclidean;
+    else if (name == "zero") heuristic = SearchHeuristic::Zero;
+    else return false;
+    return true;
+}
+
+std::string HeuristicName(SearchHeuristic heuristic){
+    switch (heuristic){
+        case SearchHeuristic::Octile: return "octile";
+        case SearchHeuristic::Euclidean: return "euclidean";
+        case SearchHeuristic::Zero: return "zero";
+        default: return "manhattan";
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+// Heuristics for the grid searches (A*, HDA). Passage costs are integers of at least 1, so every heuristic returns
+// an integer lower bound on the remaining cost; rounding down keeps the weaker ones admissible.
+enum class SearchHeuristic : int {
+    Manhattan = 1,
+    Octile = 2,
+    Euclidean = 3,
+    Zero = 4,
+};
+
+bool ParseHeuristic(const std::string &name, SearchHeuristic &heuristic);
+std::string HeuristicName(SearchHeuristic heuristic);
+
+/// @brief |dx| + |dy|, exact on an empty 4-connected grid with unit costs
+struct ManhattanHeuristic {
+    int operator()(int dx, int dy) const {return std::abs(dx) + std::abs(dy);}
+};
+
+/// @brief max + (sqrt(2) - 1) * min, in fixed point (rounded down)
+struct OctileHeuristic {
+    int operator()(int dx, int dy) const {
+        int a = std::abs(dx);
+        int b = std::abs(dy);
+        return std::max(a, b) + std::min(a, b) * 4142 / 10000;
+    }
+};
+
+/// @brief floor(sqrt(dx^2 + dy^2)), with an integer square root
+struct EuclideanHeuristic {
+    int operator()(int dx, int dy) const {
+        int value = dx * dx + dy * dy;
+        int root = 0;
+        for (int bit = 1 << 30; bit; bit >>= 2){
+            if (value >= root + bit){
+                value -= root + bit;
+                root = (root >> 1) + bit;
+            } else {
+                root >>= 1;
+            }
+        }
+        return root;
+    }
+};
+
+/// @brief Always 0, turns A* into Dijkstra
+struct ZeroHeuristic {
+    int operator()(int, int) const {return 0;}
+};
@@ -1,143 +1,364 @@
 #include "solve_a_star.h"
+#include "solve_bidirectional.h"
+#include "junction_graph.h"
+#include "hpa_star.h"
+#include "solve_bitboard.h"
+#include "solve_lanes.h"
+#include "solve_bfs_omp.h"
+#include "path_codec.h"
+#include "maze_collection.h"
 #include "maze.h"
+#include "trace.h"
+#include "search_heuristic.h"
+#include "solve_planner.h"
+#include "solve_cancel.h"
 #include "stdio.h"
 
-#ifdef USE_OMP
 #include "omp.h"
-#endif
 #ifdef USE_MPI
 #include "mpi.h"
 #endif
 
 #include <algorithm>
-#include <unordered_map>
-#include <unordered_set>
+#include <chrono>
+#include <cstdint>
 #include <limits>
 #include <deque>
+#include <functional>
+#include <memory>
+#include <queue>
 #include <vector>
 #include <stdexcept>
 
-std::vector<Cell*> FindNeighbours(const Maze &maze, const Cell c) {
-    std::vector<Cell*> neighbours;
-
-    for (const Passage &p : maze.passages) {
-        if (p.c1 && *p.c1 == c && p.c2) {
-            neighbours.emplace_back(p.c2);
-        } else if (p.c2 && *p.c2 == c && p.c1) {
-            neighbours.emplace_back(p.c1);
-        }
-    }
-    return neighbours;
+/// @brief Evaluates a heuristic functor from a maze cell to the finish
+template <typename Heuristic>
+static int HeuristicToFinish(const Maze &maze, int cell, int finish_x, int finish_y){
+    return Heuristic()(cell % maze.width() - finish_x, cell / maze.width() - finish_y);
 }
 
-float Heuristic(const Cell *a, const Cell *b){
-#ifdef USE_EUCLIDEAN
-    return sqrt(pow(a->posX - b->posX, 2) + pow(a->posY - b->posY, 2));
-#else
-    return abs(a->posX - b->posX) + abs(a->posY - b->posY);
-#endif
-}
+template <typename Cost>
+struct AStarOpenEntry {
+    Cost f_cost;
+    Cost g_cost;
+    int cell;
 
-float EuclideanDistance(const Cell *a, const Cell *b){
-    return sqrt(pow(a->posX - b->posX, 2) + pow(a->posY - b->posY, 2));
-}
-
-float ManhattanDistance(const Cell *a, const Cell *b){
-    return abs(a->posX - b->posX) + abs(a->posY - b->posY);
-}
-
-void ReconstructPath(std::unordered_map<Cell*, Cell*> &parent_of, Cell *current, std::vector<Cell*> &path){
-    while (current != nullptr){
-        path.push_back(current);
-        current = parent_of.count(current) ? parent_of[current] : nullptr;
+    // Min-heap order: lowest f first, deeper cells first on ties
+    bool operator>(const AStarOpenEntry &other) const {
+        return f_cost > other.f_cost || (f_cost == other.f_cost && g_cost < other.g_cost);
     }
-    std::reverse(path.begin(), path.end());
-}
+};
 
-/// @brief A* search algorithm https://www.geeksforgeeks.org/dsa/a-search-algorithm/
-/// @param maze 
+/// @brief A* search algorithm https://www.geeksforgeeks.org/dsa/a-search-algorithm/ on flat per-cell arrays, with a
+/// binary heap open set (lazy deletion). Specialized at compile time on the heuristic and the cost type, so the inner
+/// loop has no branches on the heuristic and no floating point.
+/// @param maze
 /// @return Vector of Cell in the order they are visited, starting with the start cell and ending with the finish cell. {} if no path is found.
-std::vector<Cell *> AStarSeq(Maze &maze){
+template <typename Heuristic, typename Cost>
+static std::vector<Cell *> AStarSearch(Maze &maze){
     if (!maze.start || !maze.finish) return {};
     if (maze.start == maze.finish) return { maze.start };
 
-    // Initialize the open and closed sets, and the g_cost and f_cost maps
-    Cell *start = maze.start;
-    Cell *finish = maze.finish;
-    std::vector<Cell*> open_set;
-    std::vector<Cell*> closed_set;
+    int num_cells = maze.width() * maze.height();
+    int start = maze.Index(maze.start);
+    int finish = maze.Index(maze.finish);
+    int finish_x = maze.finish->posX;
+    int finish_y = maze.finish->posY;
 
-    std::unordered_map<Cell*, float> g_cost;
-    std::unordered_map<Cell*, float> f_cost;
-    std::unordered_map<Cell*, Cell*> parent_of;
+    std::vector<Cost> g_cost(num_cells, std::numeric_limits<Cost>::max());
+    std::vector<int> parent(num_cells, -1);
+    std::vector<uint8_t> closed(num_cells, 0);
+    std::priority_queue<AStarOpenEntry<Cost>, std::vector<AStarOpenEntry<Cost>>, std::greater<AStarOpenEntry<Cost>>> open_set;
 
     g_cost[start] = 0;
-    f_cost[start] = Heuristic(start, finish);
-    open_set.push_back(start);
+    open_set.push({(Cost)HeuristicToFinish<Heuristic>(maze, start, finish_x, finish_y), 0, start});
 
     while (!open_set.empty()){
-        // Find the cell in open set with lowest f_cost
-        Cell *current = open_set[0];
-        for (Cell *cell : open_set){
-            if (f_cost[cell] < f_cost[current]){
-                current = cell;
-            }
-        }
+        AStarOpenEntry<Cost> entry = open_set.top();
+        open_set.pop();
+        int current = entry.cell;
+        if (closed[current] || entry.g_cost != g_cost[current]) continue;     // Outdated entry
+        closed[current] = 1;
 
         // If we reached the finish, reconstruct the path and return it
         if (current == finish){
-            // Reconstruct path
             std::vector<Cell *> path;
-            ReconstructPath(parent_of, current, path);
+            for (int cell = finish; cell != -1; cell = parent[cell]) path.push_back(maze.CellAt(cell));
+            std::reverse(path.begin(), path.end());
             return path;
         }
 
-        // Move current from open set to closed set
-        open_set.erase(std::remove(open_set.begin(), open_set.end(), current), open_set.end());
-        closed_set.push_back(current);
-
-        for(Cell* neighbour : FindNeighbours(maze, *current)){
-            if (std::find(closed_set.begin(), closed_set.end(), neighbour) != closed_set.end()){
-                continue; // Ignore the neighbour which is already evaluated
-            }
-
-            float tentative_g_cost = g_cost[current] + ManhattanDistance(current, neighbour);
-            bool inOpen = (std::find(open_set.begin(), open_set.end(), neighbour) != open_set.end());
+        uint8_t open = maze.OpenSides(current);
+        for (int dir = 0; dir < 4; dir++){
+            if (!(open & (1 << dir))) continue;
+            int neighbour = maze.Neighbour(current, dir);
+            if (closed[neighbour]) continue;    // Ignore the neighbour which is already evaluated
 
             // Best path to neighbour found so far, record it
-            if (!inOpen || tentative_g_cost < g_cost[neighbour]) {
-                parent_of[neighbour] = current;
+            Cost tentative_g_cost = g_cost[current] + (Cost)maze.Weight(current, dir);
+            if (tentative_g_cost < g_cost[neighbour]){
+                parent[neighbour] = current;
                 g_cost[neighbour] = tentative_g_cost;
-                f_cost[neighbour] = tentative_g_cost + Heuristic(neighbour, finish);
-                if (!inOpen) open_set.push_back(neighbour);
+                open_set.push({tentative_g_cost + (Cost)HeuristicToFinish<Heuristic>(maze, neighbour, finish_x, finish_y), tentative_g_cost, neighbour});
             }
         }
     }
-    
+
     return {}; // No path found
 }
 
-/// @brief Solves multiple mazes sequentially (outer maze parallelism).
-std::vector<std::vector<Cell *>> SolveSeq(std::vector<Maze>& mazes){
-    std::vector<std::vector<Cell *>> results;
-    for (Maze &maze : mazes){
-        results.push_back(AStarSeq(maze));
+/// @brief A* with the Manhattan heuristic
+std::vector<Cell *> AStarSeq(Maze &maze){
+    return AStarSearch<ManhattanHeuristic, int>(maze);
+}
+
+/// @brief Prebuilt A* specialization for a heuristic chosen at runtime
+MazeSolver AStarForHeuristic(SearchHeuristic heuristic){
+    switch (heuristic){
+        case SearchHeuristic::Octile: return AStarSearch<OctileHeuristic, int>;
+        case SearchHeuristic::Euclidean: return AStarSearch<EuclideanHeuristic, int>;
+        case SearchHeuristic::Zero: return AStarSearch<ZeroHeuristic, int>;
+        default: return AStarSearch<ManhattanHeuristic, int>;
     }
-    return results;
 }
 
+/// @brief Map the "algorithm" request parameter to a single-maze solver. The heuristic only applies to "astar".
+/// @return Solver function, nullptr if the algorithm is unknown
+MazeSolver SolverForAlgorithm(const std::string &algorithm, SearchHeuristic heuristic){
+    if (algorithm == "astar") return AStarForHeuristic(heuristic);
+    if (algorithm == "bidir") return BidirectionalSeq;
+    if (algorithm == "bidir_par") return BidirectionalPar;
+    if (algorithm == "junction") return AStarJunction;
+    if (algorithm == "hpa") return HpaStar;
+    if (algorithm == "bitboard") return FloodFillBitboard;
+    return nullptr;
+}
+
+/// @brief Batch solver that runs a single-maze solver on every maze of the range
+BatchSolver PerMaze(MazeSolver solver){
+    return [solver](std::vector<Maze> &mazes, int begin, int end){
+        PathSet results;
+        for (int i = begin; i < end; i++){
+            TraceSpan span("solve", i);
+            results.Append(mazes[i], solver(mazes[i]));
+        }
+        return results;
+    };
+}
+
+/// @brief Breadth-first solvers count steps, not passage weights. If the range has a weighted maze, A* solves it instead.
+static BatchSolver UnweightedOnly(BatchSolver solver){
+    return [solver](std::vector<Maze> &mazes, int begin, int end){
+        for (int i = begin; i < end; i++){
+            if (mazes[i].Weighted()) return PerMaze(AStarSeq)(mazes, begin, end);
+        }
+        return solver(mazes, begin, end);
+    };
+}
+
+/// @brief Map the "algorithm" request parameter to a batch solver. "lanes" solves many mazes together,
+/// every other algorithm solves them one by one. The BFS-based solvers fall back to A* on weighted mazes.
+/// @return Batch solver, empty if the algorithm is unknown
+BatchSolver BatchSolverForAlgorithm(const std::string &algorithm, SearchHeuristic heuristic){
+    if (algorithm == "lanes") return UnweightedOnly(SolveLanes);
+    MazeSolver solver = SolverForAlgorithm(algorithm, heuristic);
+    if (!solver) return nullptr;
+    if (algorithm == "bidir" || algorithm == "bidir_par" || algorithm == "bitboard") return UnweightedOnly(PerMaze(solver));
+    return PerMaze(solver);
+}
+
+/// @brief Stop state of the running SolveSelected call. Rank 0 decides (solve_cancel.h); the other ranks post a
+/// nonblocking broadcast on their own communicator at the start and poll it between units of work. Rank 0 sends the
+/// flag when it stops, or "not stopped" in Finish. Collective under MPI: constructed and finished on every rank.
+class SolveStop {
+public:
+    SolveStop();
+    bool Poll();
+    void Agree();
+    void Finish();
+    bool Stopped() const {return stopped;}
+
+private:
+    void Send();
+
+    bool stopped = false;
 #ifdef USE_MPI
-struct CellCoord {
-    int x;
-    int y;
+    int my_rank = 0;
+    int flag = 0;
+    bool posted = false;
+    MPI_Request request = MPI_REQUEST_NULL;
+#endif
 };
 
-static Cell* GetCellPtr(Maze &maze, int posX, int posY);
+#ifdef USE_MPI
+/// @brief Communicator of the stop broadcast, so it never matches a solver collective. Created on the first solve,
+/// which every rank runs.
+static MPI_Comm StopComm(){
+    static MPI_Comm comm = MPI_COMM_NULL;
+    if (comm == MPI_COMM_NULL) MPI_Comm_dup(MPI_COMM_WORLD, &comm);
+    return comm;
+}
+#endif
+
+SolveStop::SolveStop(){
+#ifdef USE_MPI
+    MPI_Comm_rank(MPI_COMM_WORLD, &my_rank);
+    MPI_Comm comm = StopComm();     // Every rank here, the first call is a collective MPI_Comm_dup
+    if (my_rank != 0){
+        MPI_Ibcast(&flag, 1, MPI_INT, 0, comm, &request);
+        posted = true;
+    }
+#endif
+}
+
+/// @brief True once this solve has to stop. Not collective: ranks may see the stop a little apart, so only use it
+/// where ranks can stop at different points (between pages, not inside a collective search).
+bool SolveStop::Poll(){
+    if (stopped) return true;
+#ifdef USE_MPI
+    if (my_rank != 0){
+        int done = 0;
+        MPI_Test(&request, &done, MPI_STATUS_IGNORE);
+        if (done && flag) stopped = true;
+        return stopped;
+    }
+#endif
+    if (SolveCancelRequested()) Agree();
+    return stopped;
+}
+
+/// @brief Stop, when every rank already knows (e.g. HDA decided it in its termination allreduce)
+void SolveStop::Agree(){
+    stopped = true;
+#ifdef USE_MPI
+    if (my_rank == 0 && !posted) Send();
+#endif
+}
 
+#ifdef USE_MPI
+void SolveStop::Send(){
+    flag = stopped ? 1 : 0;
+    MPI_Ibcast(&flag, 1, MPI_INT, 0, StopComm(), &request);
+    posted = true;
+}
+#endif
+
+/// @brief Complete the stop broadcast. Collective.
+void SolveStop::Finish(){
+#ifdef USE_MPI
+    if (my_rank == 0 && !posted) Send();
+    MPI_Wait(&request, MPI_STATUS_IGNORE);
+#endif
+}
+
+static SolveStop* active_stop = nullptr;   // Set while SolveSelected runs
+static SolveStatus status;
+
+static bool StopRequested(){
+    return active_stop && active_stop->Poll();
+}
+
+/// @brief Append empty paths for mazes [begin, end) that a stopped solve did not get to
+static void SkipMazes(const MazeCollection& mazes, int begin, int end, PathSet& results){
+    for (int i = begin; i < end; i++){
+        results.Append(mazes.width(), nullptr, 0);
+        if (i < (int)status.solved.size()) status.solved[i] = 0;
+    }
+}
+
+/// @brief Status of the last SolveSelected call, and forget it
+SolveStatus TakeSolveStatus(){
+    SolveStatus taken = std::move(status);
+    status = SolveStatus();
+    return taken;
+}
+
+#if defined(USE_MPI) || defined(USE_OMP)
+/// @brief Solves mazes[begin, end) with the OpenMP team of this process. Pages of the collection are materialized
+/// a group at a time (bounded by the cache), and each page range is cut into chunks (at most 64 mazes, so lane
+/// batches stay full) that threads take dynamically; paths keep the maze order.
+static PathSet SolveRangeThreaded(MazeCollection& mazes, const BatchSolver &solver, int begin, int end){
+    if (end <= begin) return {};
+    int threads = omp_get_max_threads();
+    int group_pages = std::max(1, std::min(threads * 4, mazes.MaxCachedPages() / 2));
+
+    struct WorkItem {
+        std::vector<Maze>* page;
+        int page_begin;
+        int local_begin, local_end;
+    };
+    PathSet results;
+    int first_page = begin / mazes.PageSize();
+    int last_page = (end - 1) / mazes.PageSize();
+    for (int group = first_page; group <= last_page; group += group_pages){
+        int group_end = std::min(last_page + 1, group + group_pages);
+        int group_begin_maze = std::max(begin, mazes.PageBegin(group));
+        if (StopRequested()){
+            SkipMazes(mazes, group_begin_maze, end, results);
+            break;
+        }
+        int group_end_maze = std::min(end, mazes.PageEnd(group_end - 1));
+        int count = group_end_maze - group_begin_maze;
+        int chunk = std::max(1, std::min(64, count / (threads * 4)));
+
+        // Materialize serially (the collection is not thread-safe), the pins keep the pages alive while solving
+        std::vector<MazeCollection::Page> pinned;
+        std::vector<WorkItem> items;
+        for (int page = group; page < group_end; page++){
+            pinned.push_back(mazes.GetPage(page));
+            int page_begin = mazes.PageBegin(page);
+            int local_begin = std::max(begin, page_begin) - page_begin;
+            int local_end = std::min(end, mazes.PageEnd(page)) - page_begin;
+            for (int i = local_begin; i < local_end; i += chunk){
+                items.push_back({pinned.back().get(), page_begin, i, std::min(local_end, i + chunk)});
+            }
+        }
+
+        // Rank 0 also drops the rest of the group as soon as it is cancelled; the others learn it at the next group
+        std::vector<PathSet> chunk_paths(items.size());
+        std::vector<uint8_t> chunk_skipped(items.size(), 0);
+        #pragma omp parallel for schedule(dynamic, 1) if (threads > 1 && items.size() > 1)
+        for (int c = 0; c < (int)items.size(); c++){
+            if (active_stop && SolveCancelRequested()){
+                chunk_skipped[c] = 1;
+                continue;
+            }
+            chunk_paths[c] = solver(*items[c].page, items[c].local_begin, items[c].local_end);
+        }
+        for (int c = 0; c < (int)items.size(); c++){
+            if (!chunk_skipped[c]) continue;
+            int page_begin = items[c].page_begin;
+            SkipMazes(mazes, page_begin + items[c].local_begin, page_begin + items[c].local_end, chunk_paths[c]);
+        }
+
+        size_t total_cells = results.TotalCells();
+        for (const PathSet& paths : chunk_paths) total_cells += paths.TotalCells();
+        results.Reserve(results.size() + count, total_cells);
+        for (const PathSet& paths : chunk_paths) results.Append(paths);
+    }
+    return results;
+}
+#endif
+
+/// @brief Solves multiple mazes sequentially (outer maze parallelism), one page of the collection at a time.
+/// A stop is checked before every page.
+PathSet SolveSeq(MazeCollection& mazes, const BatchSolver &solver){
+    PathSet results;
+    for (int page = 0; page < mazes.NumPages(); page++){
+        if (StopRequested()){
+            SkipMazes(mazes, mazes.PageBegin(page), mazes.size(), results);
+            break;
+        }
+        MazeCollection::Page page_mazes = mazes.GetPage(page);
+        results.Append(solver(*page_mazes, 0, mazes.PageEnd(page) - mazes.PageBegin(page)));
+    }
+    return results;
+}
+
+#ifdef USE_MPI
 /// @brief Solves mutiple mazes in parallel using MPI. Each process will solve a subset of all mazes. Expected speedup ~ number of cores on the CPU.
 /// @param mazes 
 /// @return Vector of paths, where each path is a vector of Cell representing the order of cells from start to finish for each maze. The order of paths corresponds to the order of mazes in the input vector.
-std::vector<std::vector<Cell *>> SolveMPI(std::vector<Maze>& mazes){
+PathSet SolveMPI(MazeCollection& mazes, const BatchSolver &solver){
     int my_rank, size;
 
     MPI_Comm_rank(MPI_COMM_WORLD, &my_rank);
@@ -149,149 +370,197 @@ std::vector<std::vector<Cell *>> SolveMPI(std::vector<Maze>& mazes){
     int startIndex = my_rank * mazesPerProcess;
     int endIndex = std::min(startIndex + mazesPerProcess, num_mazes);
 
-    // Solve local mazes
-    std::vector<std::vector<Cell *>> localResults;
-    for (int i = startIndex; i < endIndex; i++){
-        localResults.push_back(AStarSeq(mazes[i]));
+    // Solve local mazes with the OpenMP team of this rank (hybrid MPI + OpenMP). Only this rank's share is materialized.
+    PathSet localResults = SolveRangeThreaded(mazes, solver, startIndex, endIndex);
+
+    // Every rank packs its paths into one compact buffer (see path_codec.h), rank 0 collects them with one Gatherv
+    TraceSpan gather_span("gather");
+    std::vector<uint8_t> packed;
+    if (my_rank != 0){
+        for (int i = startIndex; i < endIndex; i++){
+            AppendCompactPath(localResults, i - startIndex, packed);
+        }
     }
+    int packed_size = packed.size();
+    std::vector<int> sizes(my_rank == 0 ? size : 0);
+    MPI_Gather(&packed_size, 1, MPI_INT, sizes.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
 
-    // Manual gather on node=0
+    std::vector<int> displacements;
+    std::vector<uint8_t> received;
     if (my_rank == 0){
-        std::vector<std::vector<Cell *>> allResults = localResults;
-
-        for (int source = 1; source < size; source++){
-            int numPaths;
-            MPI_Recv(&numPaths, 1, MPI_INT, source, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-
-            for (int i = 0; i < numPaths; ++i) {
-                int pathSize;
-                MPI_Recv(&pathSize, 1, MPI_INT, source, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-
-                std::vector<CellCoord> coords(pathSize);
-                if (pathSize > 0) {
-                    MPI_Recv(coords.data(), pathSize * sizeof(CellCoord), MPI_BYTE, source, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-                }
-
-                std::vector<Cell *> path;
-                path.reserve(pathSize);
-                int globalMazeIndex = source * mazesPerProcess + i;
-                for (const CellCoord& coord : coords) {
-                    if (coord.x < 0 || coord.y < 0 || globalMazeIndex < 0 || globalMazeIndex >= num_mazes) {
-                        path.push_back(nullptr);
-                    } else {
-                        path.push_back(GetCellPtr(mazes[globalMazeIndex], coord.x, coord.y));
-                    }
-                }
-
-                allResults.push_back(std::move(path));
-            }
+        displacements.assign(size + 1, 0);
+        for (int source = 0; source < size; source++) displacements[source + 1] = displacements[source] + sizes[source];
+        received.resize(displacements[size]);
+    }
+    MPI_Gatherv(packed.data(), packed_size, MPI_BYTE, received.data(), sizes.data(), displacements.data(), MPI_BYTE, 0, MPI_COMM_WORLD);
+
+    // Under SolveSelected a rank may have stopped early, rank 0 collects which mazes of every share were finished
+    if (active_stop){
+        std::vector<int> share_sizes(my_rank == 0 ? size : 0);
+        std::vector<int> share_begins(my_rank == 0 ? size : 0);
+        for (int source = 0; source < (int)share_sizes.size(); source++){
+            share_begins[source] = std::min(num_mazes, source * mazesPerProcess);
+            share_sizes[source] = std::min(num_mazes, share_begins[source] + mazesPerProcess) - share_begins[source];
         }
-
-        return allResults;
-    } 
-    else {
-        int numPaths = localResults.size();
-        MPI_Send(&numPaths, 1, MPI_INT, 0, 0, MPI_COMM_WORLD);
-        for (const std::vector<Cell *>& path : localResults) {
-            int pathSize = path.size();
-            MPI_Send(&pathSize, 1, MPI_INT, 0, 0, MPI_COMM_WORLD);
-
-            std::vector<CellCoord> coords;
-            coords.reserve(path.size());
-            for (Cell* cell : path) {
-                if (cell) {
-                    coords.push_back({cell->posX, cell->posY});
-                } else {
-                    coords.push_back({-1, -1});
-                }
-            }
-
-            if (pathSize > 0) {
-                MPI_Send(coords.data(), pathSize * sizeof(CellCoord), MPI_BYTE, 0, 0, MPI_COMM_WORLD);
-            }
+        int share_size = std::max(0, endIndex - startIndex);
+        if (my_rank == 0){
+            MPI_Gatherv(MPI_IN_PLACE, share_size, MPI_BYTE, status.solved.data(), share_sizes.data(), share_begins.data(), MPI_BYTE, 0, MPI_COMM_WORLD);
+        } else {
+            MPI_Gatherv(status.solved.data() + std::min(startIndex, num_mazes), share_size, MPI_BYTE, nullptr, nullptr, nullptr, MPI_BYTE, 0, MPI_COMM_WORLD);
         }
+    }
+    if (my_rank != 0) return {};
 
-        return {};
+    std::vector<PathSet> sourceResults(size);
+    sourceResults[0] = std::move(localResults);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int source = 1; source < size; source++){
+        const uint8_t* data = received.data() + displacements[source];
+        int sourceEnd = std::min((source + 1) * mazesPerProcess, num_mazes);
+        for (int i = source * mazesPerProcess; i < sourceEnd; i++){
+            data += ReadCompactPath(data, mazes.width(), sourceResults[source]);
+        }
     }
+
+    PathSet allResults = std::move(sourceResults[0]);
+    for (int source = 1; source < size; source++) allResults.Append(sourceResults[source]);
+    return allResults;
 }
 
 /// @brief Solves multiple mazes in parallel (inter-maze): MPI process farm.
-std::vector<std::vector<Cell *>> SolveInterMaze(std::vector<Maze>& mazes){
-    return SolveMPI(mazes);
+PathSet SolveInterMaze(MazeCollection& mazes, const BatchSolver &solver){
+    return SolveMPI(mazes, solver);
 }
 
-std::vector<Cell *> HDA(Maze& maze);
+// Bounds left by an HDA search that was stopped before it finished
+struct SearchBounds {
+    bool stopped = false;
+    int lower = 0;
+    int upper = -1;     // -1 if no start-to-finish path was found yet
+};
 
-#ifdef USE_MPI
-/// @brief Solves one maze at a time with HDA (intra-maze parallelism).
-std::vector<std::vector<Cell *>> SolveIntraMaze(std::vector<Maze>& mazes){
-    std::vector<std::vector<Cell *>> results;
-    results.reserve(mazes.size());
-    for (Maze &maze : mazes){
-        results.push_back(HDA(maze));
+std::vector<Cell *> HDA(Maze& maze, SearchHeuristic heuristic, SearchBounds* bounds = nullptr);
+
+/// @brief Solves one maze at a time with HDA (intra-maze parallelism). A stop is agreed inside HDA, so every rank
+/// leaves the loop at the same maze.
+PathSet SolveIntraMaze(MazeCollection& mazes, SearchHeuristic heuristic){
+    PathSet results;
+    for (int i = 0; i < mazes.size(); i++){
+        if (active_stop && active_stop->Stopped()){
+            SkipMazes(mazes, i, mazes.size(), results);
+            break;
+        }
+        TraceSpan span("solve", i);
+        std::shared_ptr<Maze> maze = mazes.Get(i);
+        SearchBounds bounds;
+        results.Append(*maze, HDA(*maze, heuristic, &bounds));
+        if (bounds.stopped){
+            if (active_stop) active_stop->Agree();
+            if (i < (int)status.solved.size()) status.solved[i] = 0;
+            status.bound_maze = i;
+            status.lower_bound = bounds.lower;
+            status.upper_bound = bounds.upper;
+        }
     }
     return results;
 }
-#endif
 
-std::vector<std::vector<Cell *>> SolveSelected(std::vector<Maze>& mazes, const std::string &mode){
-    if (mode == "inter"){
-        // UI "inter" means inter-maze parallelism.
-        printf("Solving Maze [INTER-MAZE]...\n");
-        return SolveInterMaze(mazes);
-    } else if (mode == "intra"){
-        // UI "intra" means intra-maze parallelism.
-        printf("Solving Maze [INTRA-MAZE]...\n");
-        return SolveIntraMaze(mazes);
-    } else if (mode == "combined"){
-        printf("Solving Maze [COMBINED] (fallback to INTER-MAZE only; full combined not implemented yet)...\n");
-        return SolveInterMaze(mazes);
-    } else if (mode == "sequential"){
-        printf("Solving Maze [SEQUENTIAL]...\n");
-        return SolveSeq(mazes);
-    }
+struct HDAMessage {
+    int cell;
+    int tentative_g_cost;
+    int parent;
+};
 
-    throw std::invalid_argument("Invalid mode: " + mode);
-}
+// Backtrack token: the next path cell to look up on its owner, and its position counted from the finish
+struct BacktrackToken {
+    int cell;
+    int position;
+};
 
-struct HDAMessage {
-    int posX, posY;
-    float tentative_g_cost;
-    int parentX, parentY;
+// Path cell recorded by the rank that owns it
+struct PathRecord {
+    int position;
+    int cell;
 };
 
-struct ParentEntry {
-    int childX, childY;
-    int parentX, parentY;
+struct HDAExpansion {
+    int neighbour;
+    int parent;
+    int tentative_g_cost;
 };
 
 static const int MSG_TAG = 1;
+static const int BACKTRACK_TAG = 2;
+static const int HDA_BATCH_PER_THREAD = 8;
 
 /// @brief Creates a hash for a cell based on coordinates. Used for hashing cells in the HDA algorithm.
 /// @return Hash value for each cell. Should be unique but not guarenteed.
-static int HDAHash(const Cell *cell, int num_ranks){
+static int HDAHash(int posX, int posY, int num_ranks){
     // 73856093 and 19349663 are large primes
     // ^ is bitwise XOR
-    size_t h = (size_t)(cell -> posX * 73856093) ^ (cell -> posY * 19349663);
+    size_t h = (size_t)(posX * 73856093) ^ (posY * 19349663);
     return h % num_ranks;
 }
 
-static Cell* GetCellPtr(Maze &maze, int posX, int posY){
-    // Get pointer to cell at (posX, posY) in maze.
-    if (posX < 0 || posX >= maze.width() || posY < 0 || posY >= maze.height()) return nullptr;
-    return &maze.cells[posY][posX];
-}
+struct HDAOpenEntry {
+    int f_cost;
+    int g_cost;
+    int local;
 
+    // Min-heap order: lowest f first, deeper cells first on ties
+    bool operator>(const HDAOpenEntry& other) const {
+        return f_cost > other.f_cost || (f_cost == other.f_cost && g_cost < other.g_cost);
+    }
+};
+
+/// @brief Search state of one rank. The cells it owns are numbered 0..owned.size()-1 and their costs, parents
+/// and closed flags live in flat arrays. The open set is a binary heap with lazy deletion: an improved cell is
+/// pushed again and outdated entries are skipped when popped.
 struct HDAState {
-    std::vector<Cell*> open_set;
-    std::unordered_set<Cell*> closed_set;
-    std::unordered_map<Cell*, float> g_cost;
-    std::unordered_map<Cell*, float> f_cost;
-    std::unordered_map<Cell*, Cell*> parent_of;
+    HDAState(const Maze& maze, int my_rank, int size);
+
+    int Owner(int cell) const {return HDAHash(cell % width, cell / width, size);}
+
+    int width;
+    int size;
+    std::vector<int> local_of;      // Maze cell index -> local index, -1 for cells owned by other ranks
+    std::vector<int> owned;         // Local index -> maze cell index
+    std::vector<int> g_cost;
+    std::vector<int> parent;        // Maze cell index of the parent, -1 if none
+    std::vector<uint8_t> closed;    // Expanded with its current g_cost
+    std::priority_queue<HDAOpenEntry, std::vector<HDAOpenEntry>, std::greater<HDAOpenEntry>> open_set;
     int msgs_received = 0;
 };
 
-static void DrainHDAInbox(Maze& maze, Cell* finish, HDAState& state){
+HDAState::HDAState(const Maze& maze, int my_rank, int size)
+: width(maze.width()), size(size)
+{
+    int num_cells = maze.width() * maze.height();
+    local_of.assign(num_cells, -1);
+    for (int cell = 0; cell < num_cells; cell++){
+        if (Owner(cell) != my_rank) continue;
+        local_of[cell] = owned.size();
+        owned.push_back(cell);
+    }
+    g_cost.assign(owned.size(), std::numeric_limits<int>::max());
+    parent.assign(owned.size(), -1);
+    closed.assign(owned.size(), 0);
+}
+
+/// @brief Lower the cost of an owned cell if the new path is shorter, and (re)open it
+template <typename Heuristic>
+static void RelaxOwned(Maze& maze, HDAState& state, int cell, int tentative_g_cost, int parent){
+    int local = state.local_of[cell];
+    if (tentative_g_cost >= state.g_cost[local]) return;
+    state.g_cost[local] = tentative_g_cost;
+    state.parent[local] = parent;
+    state.closed[local] = 0;
+    state.open_set.push({tentative_g_cost + HeuristicToFinish<Heuristic>(maze, cell, maze.finish->posX, maze.finish->posY), tentative_g_cost, local});
+}
+
+template <typename Heuristic>
+static void DrainHDAInbox(Maze& maze, HDAState& state){
+    TraceSpan span("drain_inbox");
     MPI_Status status;
     int flag = 0;
     MPI_Iprobe(MPI_ANY_SOURCE, MSG_TAG, MPI_COMM_WORLD, &flag, &status);
@@ -300,29 +569,105 @@ static void DrainHDAInbox(Maze& maze, Cell* finish, HDAState& state){
         MPI_Recv(&msg, sizeof(HDAMessage), MPI_BYTE, status.MPI_SOURCE, MSG_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
         state.msgs_received++;
 
-        Cell* neighbour = GetCellPtr(maze, msg.posX, msg.posY);
-        Cell* parent = GetCellPtr(maze, msg.parentX, msg.parentY);
-        if (!neighbour || !parent) {
-            MPI_Iprobe(MPI_ANY_SOURCE, MSG_TAG, MPI_COMM_WORLD, &flag, &status);
-            continue;
+        if (msg.cell >= 0 && msg.cell < (int)state.local_of.size() && state.local_of[msg.cell] >= 0){
+            RelaxOwned<Heuristic>(maze, state, msg.cell, msg.tentative_g_cost, msg.parent);
         }
 
-        auto it = state.g_cost.find(neighbour);
-        if (it == state.g_cost.end() || msg.tentative_g_cost < it->second){
-            state.g_cost[neighbour] = msg.tentative_g_cost;
-            state.f_cost[neighbour] = msg.tentative_g_cost + Heuristic(neighbour, finish);
-            state.parent_of[neighbour] = parent;
-            state.open_set.push_back(neighbour);
+        MPI_Iprobe(MPI_ANY_SOURCE, MSG_TAG, MPI_COMM_WORLD, &flag, &status);
+    }
+}
+
+/// @brief Rebuild the HDA path without collecting parent maps. The parent of a cell lives on the cell's owner,
+/// so a token walks from the finish to the start: each rank follows the chain while it owns the cells, records
+/// them, and passes the token to the owner of the next one. Only path cells are then gathered on rank 0.
+/// @return Path from start to finish on rank 0 ({} if the finish was not reached), {} on the other ranks
+static std::vector<Cell*> BacktrackHDAPath(Maze& maze, HDAState& state, int my_rank, int size){
+    TraceSpan gather_span("gather");
+    int start = maze.Index(maze.start);
+    int finish = maze.Index(maze.finish);
+    std::vector<PathRecord> records;
+
+    auto finish_token = [&](){
+        BacktrackToken done = { -1, -1 };
+        for (int rank = 0; rank < size; rank++){
+            if (rank != my_rank) MPI_Send(&done, sizeof(done), MPI_BYTE, rank, BACKTRACK_TAG, MPI_COMM_WORLD);
+        }
+    };
+
+    BacktrackToken token = { -1, -1 };
+    bool holding = false;
+    bool done = false;
+    if (state.Owner(finish) == my_rank){
+        if (state.parent[state.local_of[finish]] != -1){
+            token = { finish, 0 };
+            holding = true;
+        } else {
+            finish_token();     // Finish not reached, no path
+            done = true;
         }
+    }
 
-        MPI_Iprobe(MPI_ANY_SOURCE, MSG_TAG, MPI_COMM_WORLD, &flag, &status);
+    while (!done){
+        if (!holding){
+            MPI_Recv(&token, sizeof(token), MPI_BYTE, MPI_ANY_SOURCE, BACKTRACK_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            if (token.cell < 0) break;
+        }
+        holding = false;
+
+        int current = token.cell;
+        int position = token.position;
+        bool reached_start = false;
+        while (true){
+            records.push_back({position, current});
+            if (current == start){
+                reached_start = true;
+                break;
+            }
+            current = state.parent[state.local_of[current]];
+            position++;
+            if (state.Owner(current) != my_rank) break;
+        }
+
+        if (reached_start){
+            finish_token();
+            break;
+        }
+        BacktrackToken next = { current, position };
+        MPI_Send(&next, sizeof(next), MPI_BYTE, state.Owner(current), BACKTRACK_TAG, MPI_COMM_WORLD);
+    }
+
+    // Gather the recorded path cells on rank 0 and order them from start to finish
+    int num_bytes = records.size() * sizeof(PathRecord);
+    std::vector<int> sizes(my_rank == 0 ? size : 0);
+    MPI_Gather(&num_bytes, 1, MPI_INT, sizes.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+    std::vector<int> displacements(my_rank == 0 ? size : 0);
+    std::vector<PathRecord> all_records;
+    if (my_rank == 0){
+        int total = 0;
+        for (int rank = 0; rank < size; rank++){
+            displacements[rank] = total;
+            total += sizes[rank];
+        }
+        all_records.resize(total / sizeof(PathRecord));
+    }
+    MPI_Gatherv(records.data(), num_bytes, MPI_BYTE, all_records.data(), sizes.data(), displacements.data(), MPI_BYTE, 0, MPI_COMM_WORLD);
+    if (my_rank != 0) return {};
+
+    std::vector<Cell*> path(all_records.size());
+    for (const PathRecord& record : all_records){
+        path[path.size() - 1 - record.position] = maze.CellAt(record.cell);
     }
+    return path;
 }
 
 /// @brief Hash distributed A* search algorithm. Each process is responsible for a subset of cells based on the hash of their coordinates.
-/// Processes communicate to share information about the best path found so far.
+/// Processes communicate to share information about the best path found so far. Rank 0's cancel flag (solve_cancel.h)
+/// travels in the termination allreduce, so every rank stops in the same round; the search then only delivers the
+/// messages in flight and reports cost bounds instead of a path.
 /// @param maze
-std::vector<Cell *> HDA(Maze& maze){
+/// @param bounds Set when the search was stopped, may be nullptr
+template <typename Heuristic>
+static std::vector<Cell *> HDASearch(Maze& maze, SearchBounds* bounds){
     int my_rank, size;
     MPI_Comm_rank(MPI_COMM_WORLD, &my_rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
@@ -330,90 +675,117 @@ std::vector<Cell *> HDA(Maze& maze){
     if (!maze.start || !maze.finish) return {};
     if (maze.start == maze.finish) return { maze.start };
 
-    Cell * start = maze.start;
-    Cell * finish = maze.finish;
+    int start = maze.Index(maze.start);
+    int finish = maze.Index(maze.finish);
 
     // Per-rank state
-    HDAState state;
+    HDAState state(maze, my_rank, size);
 
     // Send buffer and pending MPI requests
     std::deque<HDAMessage> send_buffer;
     std::vector<MPI_Request> pending_sends;
 
-    float best_local_g_cost = std::numeric_limits<float>::infinity();
+    int best_local_g_cost = std::numeric_limits<int>::max();
 
     int msgs_sent = 0;
-    int msgs_received = 0;
+
+    // Threads of this rank expanding open cells together
+    int threads = omp_get_max_threads();
+    int batch_limit = threads > 1 ? threads * HDA_BATCH_PER_THREAD : 1;
+    std::vector<std::vector<HDAExpansion>> expanded(threads);
+    std::vector<int> batch;
 
     // Seed: only the rank responsible for the start cell initializes the open set
-    if (HDAHash(start, size) == my_rank){
-        state.g_cost[start] = 0;
-        state.f_cost[start] = Heuristic(start, finish);
-        state.open_set.push_back(start);
+    if (state.Owner(start) == my_rank){
+        RelaxOwned<Heuristic>(maze, state, start, 0, -1);
     }
 
+    bool stopping = false;
+
     // Main loop
     while (true){
-        DrainHDAInbox(maze, finish, state);
-
-        // Synchronization block: check if all processes are idle (open set empty) and if so, terminate
-        int local_idle = state.open_set.empty() ? 1 : 0;
-        int global_idle = 0;
-        int total_sent = 0;
-        int total_received = 0;
-
-        MPI_Allreduce(&local_idle, &global_idle, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
-        MPI_Allreduce(&msgs_sent, &total_sent, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
-        MPI_Allreduce(&state.msgs_received, &total_received, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+        DrainHDAInbox<Heuristic>(maze, state);
+
+        // Synchronization block: check if all processes are idle (open set empty) and if so, terminate.
+        // One allreduce for the idle count, the message counts and the stop requests.
+        int local[4] = { state.open_set.empty() ? 1 : 0, msgs_sent, state.msgs_received, SolveCancelRequested() ? 1 : 0 };
+        int global[4] = { 0, 0, 0, 0 };
+        {
+            TraceSpan span("allreduce");
+            MPI_Allreduce(local, global, 4, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+        }
+        int global_idle = global[0];
+        int total_sent = global[1];
+        int total_received = global[2];
 
         if (global_idle == size && total_sent == total_received) break;
 
+        // Stopped: expand nothing more, only wait until every message sent so far has been received
+        if (global[3] > 0) stopping = true;
+        if (stopping){
+            if (total_sent == total_received) break;
+            continue;
+        }
+
         if (state.open_set.empty()) continue;
 
-        auto best = std::min_element(state.open_set.begin(), state.open_set.end(), [&](Cell* a, Cell* b){
-            return state.f_cost[a] < state.f_cost[b];
-        });
+        // Take the best cells of the open set, one per round single-threaded, HDA_BATCH_PER_THREAD per thread otherwise
+        batch.clear();
+        while ((int)batch.size() < batch_limit && !state.open_set.empty()){
+            HDAOpenEntry entry = state.open_set.top();
+            state.open_set.pop();
 
-        Cell* current = *best;
-        state.open_set.erase(best);
+            int local = entry.local;
+            if (state.closed[local] || entry.g_cost != state.g_cost[local]) continue;     // Outdated entry
+            if (state.g_cost[local] >= best_local_g_cost) continue;
+            state.closed[local] = 1;
 
-        if (state.closed_set.count(current)) continue;
+            if (state.owned[local] == finish){
+                best_local_g_cost = state.g_cost[local];
+                continue;
+            }
+            batch.push_back(local);
+        }
 
-        if(!state.g_cost.count(current) || state.g_cost[current] >= best_local_g_cost) continue;
+        // Expand the batch on the OpenMP team. Threads only read the search state; MPI stays on this thread.
+        for (auto& list : expanded) list.clear();
+        #pragma omp parallel for schedule(dynamic, 1) num_threads(threads) if (batch.size() > 1)
+        for (size_t b = 0; b < batch.size(); b++){
+            int current = state.owned[batch[b]];
+            int current_g_cost = state.g_cost[batch[b]];
+            uint8_t open = maze.OpenSides(current);
+            for (int dir = 0; dir < 4; dir++){
+                if (!(open & (1 << dir))) continue;
+                int neighbour = maze.Neighbour(current, dir);
 
-        if (current == finish){
-            best_local_g_cost = state.g_cost[current];
-            continue;
-        }
+                int tentative_g_cost = current_g_cost + maze.Weight(current, dir);
 
-        for (Cell* neighbour : FindNeighbours(maze, *current)) {
-            if (state.closed_set.count(neighbour)) continue;
+                if (tentative_g_cost >= best_local_g_cost) continue;
 
-            float tentative_g_cost = state.g_cost[current] + ManhattanDistance(current, neighbour);
+                expanded[omp_get_thread_num()].push_back({neighbour, current, tentative_g_cost});
+            }
+        }
 
-            if (tentative_g_cost >= best_local_g_cost) continue;
+        for (const auto& list : expanded) {
+            for (const HDAExpansion& expansion : list) {
+                if (expansion.tentative_g_cost >= best_local_g_cost) continue;
 
-            int owner = HDAHash(neighbour, size);
+                int owner = state.Owner(expansion.neighbour);
 
-            if (owner == my_rank) {
-                auto it = state.g_cost.find(neighbour);
-                if (it == state.g_cost.end() || tentative_g_cost < it->second) {
-                    state.g_cost[neighbour] = tentative_g_cost;
-                    state.f_cost[neighbour] = tentative_g_cost + Heuristic(neighbour, finish);
-                    state.parent_of[neighbour] = current;
-                    state.open_set.push_back(neighbour);
-                }
-            } else {
-                send_buffer.push_back({neighbour->posX, neighbour->posY, tentative_g_cost, current->posX, current->posY});
-                MPI_Request req;
-                MPI_Isend(&send_buffer.back(), sizeof(HDAMessage), MPI_BYTE, owner, MSG_TAG, MPI_COMM_WORLD, &req);
-                pending_sends.push_back(req);
-                msgs_sent++;
-
-                if ((int)pending_sends.size() >= 64) {
-                    MPI_Waitall((int)pending_sends.size(), pending_sends.data(), MPI_STATUSES_IGNORE);
-                    pending_sends.clear();
-                    send_buffer.clear();
+                if (owner == my_rank) {
+                    RelaxOwned<Heuristic>(maze, state, expansion.neighbour, expansion.tentative_g_cost, expansion.parent);
+                } else {
+                    send_buffer.push_back({expansion.neighbour, expansion.tentative_g_cost, expansion.parent});
+                    MPI_Request req;
+                    MPI_Isend(&send_buffer.back(), sizeof(HDAMessage), MPI_BYTE, owner, MSG_TAG, MPI_COMM_WORLD, &req);
+                    pending_sends.push_back(req);
+                    msgs_sent++;
+
+                    if ((int)pending_sends.size() >= 64) {
+                        MPI_Waitall((int)pending_sends.size(), pending_sends.data(), MPI_STATUSES_IGNORE);
+                        pending_sends.clear();
+                        send_buffer.clear();
+                    }
                 }
             }
         }
@@ -426,52 +798,127 @@ std::vector<Cell *> HDA(Maze& maze){
         send_buffer.clear();
     }
 
-    std::vector<ParentEntry> local_parents;
-    local_parents.reserve(state.parent_of.size());
-    for (auto& [child, parent] : state.parent_of){
-        local_parents.push_back({child->posX, child->posY, parent->posX, parent->posY});
-    }
-
-    // Send parent information to rank 0 for path reconstruction.
-    if (my_rank != 0){
-        int num_parents = local_parents.size();
-        MPI_Send(&num_parents, 1, MPI_INT, 0, 0, MPI_COMM_WORLD);
-        if (num_parents > 0){
-            MPI_Send(local_parents.data(), num_parents * sizeof(ParentEntry), MPI_BYTE, 0, 0, MPI_COMM_WORLD);
+    if (stopping){
+        // The optimal cost is at least the lowest f still open anywhere (the heuristic is admissible), and at most
+        // the cost of the best path to the finish found so far
+        int local_bounds[2] = { std::numeric_limits<int>::max(), std::numeric_limits<int>::max() };
+        if (!state.open_set.empty()) local_bounds[0] = state.open_set.top().f_cost;
+        if (state.Owner(finish) == my_rank) local_bounds[1] = state.g_cost[state.local_of[finish]];
+        int global_bounds[2];
+        MPI_Allreduce(local_bounds, global_bounds, 2, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+        if (bounds){
+            bool found = global_bounds[1] != std::numeric_limits<int>::max();
+            bounds->stopped = true;
+            bounds->upper = found ? global_bounds[1] : -1;
+            bounds->lower = found ? std::min(global_bounds[0], global_bounds[1]) : global_bounds[0];
+            if (bounds->lower == std::numeric_limits<int>::max()) bounds->lower = 0;
         }
         return {};
     }
 
-    // Rank 0 gathers parent information from all ranks and reconstructs the path
-    std::unordered_map<Cell*, Cell*> merged = state.parent_of;
+    return BacktrackHDAPath(maze, state, my_rank, size);
+}
 
-    for (int source = 1; source < size; source++){
-        int num_parents = 0;
-        MPI_Recv(&num_parents, 1, MPI_INT, source, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-        if (num_parents == 0) continue;
-
-        std::vector<ParentEntry> entries(num_parents);
-        MPI_Recv(entries.data(), num_parents * sizeof(ParentEntry), MPI_BYTE, source, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-
-        for (const ParentEntry& entry : entries){
-            Cell* child = GetCellPtr(maze, entry.childX, entry.childY);
-            Cell* parent = GetCellPtr(maze, entry.parentX, entry.parentY);
-            if (child && parent){
-                merged[child] = parent;
-            }
-        }
+/// @brief HDA with a heuristic chosen at runtime. All ranks must pass the same heuristic.
+std::vector<Cell *> HDA(Maze& maze, SearchHeuristic heuristic, SearchBounds* bounds){
+    switch (heuristic){
+        case SearchHeuristic::Octile: return HDASearch<OctileHeuristic>(maze, bounds);
+        case SearchHeuristic::Euclidean: return HDASearch<EuclideanHeuristic>(maze, bounds);
+        case SearchHeuristic::Zero: return HDASearch<ZeroHeuristic>(maze, bounds);
+        default: return HDASearch<ManhattanHeuristic>(maze, bounds);
     }
+}
 
-    std::vector<Cell*> path;
-    ReconstructPath(merged, finish, path);
-    return path;
+#else
+/// @brief Without MPI there is only one process. The OpenMP build spreads the mazes over its threads, the sequential build solves them in order.
+PathSet SolveInterMaze(MazeCollection& mazes, const BatchSolver &solver){
+#ifdef USE_OMP
+    return SolveRangeThreaded(mazes, solver, 0, mazes.size());
+#else
+    return SolveSeq(mazes, solver);
+#endif
+}
+
+/// @brief Without MPI there is no HDA. The OpenMP build solves each maze with the threaded BFS, the sequential build with A*.
+PathSet SolveIntraMaze(MazeCollection& mazes, SearchHeuristic heuristic){
+#ifdef USE_OMP
+    (void)heuristic;
+    return SolveOMP(mazes);
+#else
+    return SolveSeq(mazes, PerMaze(AStarForHeuristic(heuristic)));
+#endif
 }
 #endif
 
+/// @brief Solve every maze with the given mode and algorithm. The algorithm applies to the inter/sequential modes; intra always runs HDA.
+/// The heuristic applies to A* and HDA. "auto" picks one of sequential, inter and intra with the calibrated cost model (solve_planner.h).
+/// The solve stops early when rank 0's cancel (solve_cancel.h) trips; TakeSolveStatus tells which mazes were finished.
+PathSet SolveSelected(MazeCollection& mazes, const std::string &mode, const std::string &algorithm, const std::string &heuristic_name){
+    SearchHeuristic heuristic;
+    if (!ParseHeuristic(heuristic_name, heuristic)){
+        throw std::invalid_argument("Invalid heuristic: " + heuristic_name);
+    }
+    BatchSolver solver = BatchSolverForAlgorithm(algorithm, heuristic);
+    if (!solver){
+        throw std::invalid_argument("Invalid algorithm: " + algorithm);
+    }
+
+    if (mode == "auto"){
+        // Same plan on every rank (see PlanSolve), so the workers follow rank 0 into the chosen mode
+        SolvePlan plan = PlanSolve(mazes, algorithm);
+        printf("Solving Maze [AUTO] predicted sequential %.2f ms, inter %.2f ms, intra %.2f ms -> %s\n",
+            plan.sequential_ms, plan.inter_ms, plan.intra_ms, plan.mode.c_str());
+        auto t0 = std::chrono::steady_clock::now();
+        PathSet paths = SolveSelected(mazes, plan.mode, algorithm, heuristic_name);
+        plan.actual_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        printf("[AUTO] %s: predicted %.2f ms, actual %.2f ms\n", plan.mode.c_str(), plan.predicted_ms, plan.actual_ms);
+        RecordSolvePlan(plan);
+        return paths;
+    }
+    if (mode != "inter" && mode != "intra" && mode != "combined" && mode != "sequential"){
+        throw std::invalid_argument("Invalid mode: " + mode);
+    }
+
+    // The solvers poll active_stop and record skipped mazes in status
+    SolveStop stop;
+    struct ActiveStop {
+        explicit ActiveStop(SolveStop* stop) {active_stop = stop;}
+        ~ActiveStop() {active_stop = nullptr;}
+    } active(&stop);
+    status = SolveStatus();
+    status.solved.assign(mazes.size(), 1);
+
+    PathSet paths;
+    if (mode == "inter"){
+        // UI "inter" means inter-maze parallelism.
+        printf("Solving Maze [INTER-MAZE]...\n");
+        paths = SolveInterMaze(mazes, solver);
+    } else if (mode == "intra"){
+        // UI "intra" means intra-maze parallelism.
+        printf("Solving Maze [INTRA-MAZE]...\n");
+        paths = SolveIntraMaze(mazes, heuristic);
+    } else if (mode == "combined"){
+        printf("Solving Maze [COMBINED] (fallback to INTER-MAZE only; full combined not implemented yet)...\n");
+        paths = SolveInterMaze(mazes, solver);
+    } else {
+        printf("Solving Maze [SEQUENTIAL]...\n");
+        paths = SolveSeq(mazes, solver);
+    }
+    stop.Finish();
+
+    int finished = (int)std::count(status.solved.begin(), status.solved.end(), 1);
+    status.stopped = finished < mazes.size();
+    if (status.stopped){
+        status.reason = SolveCancelReason();
+        printf("Solve stopped (%s): %d of %d maze(s) finished\n", status.reason.c_str(), finished, mazes.size());
+    }
+    return paths;
+}
+
 #ifdef USE_OMP
-std::vector<std::vector<Cell *>> SolveOMP(std::vector<Maze>& mazes){
-    std::printf("Not implemented yet\n");
-    return {};
+/// @brief Solves the mazes one after another, each with all OpenMP threads (shared-memory intra-maze parallelism).
+PathSet SolveOMP(MazeCollection& mazes){
+    return SolveSeq(mazes, UnweightedOnly(PerMaze(ParallelBFS)));
 }
 #endif
 
@@ -491,12 +938,8 @@ bool PathEqual(const std::vector<Cell*>& a, const std::vector<Cell*>& b){
     return true;
 }
 
-/// @brief Wrapper to check if path vectors are equal
+/// @brief Wrapper to check if path sets are equal. Compares the flat buffers, no per-path work.
 /// @return True if all paths are equal, false otherwise
-bool PathsEqual(const std::vector<std::vector<Cell*>>& a, const std::vector<std::vector<Cell*>>& b){
-    if (a.size() != b.size()) return false;
-    for (size_t i = 0; i < a.size(); i++){
-        if (!PathEqual(a[i], b[i])) return false;
-    }
-    return true;
+bool PathsEqual(const PathSet& a, const PathSet& b){
+    return a == b;
 }
\ No newline at end of file
@@ -1,12 +1,41 @@
+#pragma once
 #include "maze.h"
+#include "path_set.h"
+#include "maze_collection.h"
+#include "search_heuristic.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Single-maze solver used by the batch solvers
+using MazeSolver = std::vector<Cell *> (*)(Maze &maze);
+// Solver for the range [begin, end) of a batch, returning one path per maze in order
+using BatchSolver = std::function<PathSet(std::vector<Maze> &mazes, int begin, int end)>;
+
+/// @brief How the last SolveSelected call ended (meaningful on rank 0). A stopped solve (timeout or cancel, see
+/// solve_cancel.h) returns empty paths for the mazes it did not finish; `solved` marks the paths that are final.
+struct SolveStatus {
+    bool stopped = false;
+    std::string reason;             // "timeout" or "cancelled" when stopped
+    std::vector<uint8_t> solved;    // One flag per maze
+    int bound_maze = -1;            // Maze an intra-maze search was interrupted in, -1 if none
+    int lower_bound = 0;            // Its path cost is at least this (lowest f left in the open sets)
+    int upper_bound = -1;           // Cost of the best start-to-finish path found so far, -1 if none
+};
 
 std::vector<Cell *> AStarSeq(Maze &maze);
-std::vector<std::vector<Cell *>> SolveInterMaze(std::vector<Maze> &mazes);
-std::vector<std::vector<Cell *>> SolveIntraMaze(std::vector<Maze> &mazes);
-std::vector<std::vector<Cell *>> SolveSeq(std::vector<Maze> &mazes);
-std::vector<std::vector<Cell *>> SolveSeq(std::vector<Maze> &mazes);
-std::vector<std::vector<Cell *>> SolveSelected(std::vector<Maze> &mazes, const std::string &mode);
-std::vector<std::vector<Cell *>> SolveMPI(std::vector<Maze> &mazes);
-std::vector<std::vector<Cell *>> SolveOMP(std::vector<Maze>& mazes);
+MazeSolver AStarForHeuristic(SearchHeuristic heuristic);
+MazeSolver SolverForAlgorithm(const std::string &algorithm, SearchHeuristic heuristic = SearchHeuristic::Manhattan);
+BatchSolver PerMaze(MazeSolver solver);
+BatchSolver BatchSolverForAlgorithm(const std::string &algorithm, SearchHeuristic heuristic = SearchHeuristic::Manhattan);
+PathSet SolveInterMaze(MazeCollection &mazes, const BatchSolver &solver = PerMaze(AStarSeq));
+PathSet SolveIntraMaze(MazeCollection &mazes, SearchHeuristic heuristic = SearchHeuristic::Manhattan);
+PathSet SolveSeq(MazeCollection &mazes, const BatchSolver &solver = PerMaze(AStarSeq));
+PathSet SolveSelected(MazeCollection &mazes, const std::string &mode, const std::string &algorithm = "astar", const std::string &heuristic = "manhattan");
+PathSet SolveMPI(MazeCollection &mazes, const BatchSolver &solver = PerMaze(AStarSeq));
+PathSet SolveOMP(MazeCollection &mazes);
+SolveStatus TakeSolveStatus();
 bool PathEqual(const std::vector<Cell*>& a, const std::vector<Cell*>& b);
-bool PathsEqual(const std::vector<std::vector<Cell*>>& a, const std::vector<std::vector<Cell*>>& b);
\ No newline at end of file
+bool PathsEqual(const PathSet& a, const PathSet& b);
@@ -0,0 +1,120 @@
+#include "solve_bfs_omp.h"
+#include "maze.h"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Direction-optimizing switch points (Beamer et al.): go bottom-up once the frontier is larger than
+// unvisited / ALPHA, and back to top-down once it shrinks below cells / BETA
+static const int ALPHA = 14;
+static const int BETA = 24;
+// Levels with fewer frontier cells than this run on one thread, the fork/join would cost more than the work
+static const int PARALLEL_THRESHOLD = 1024;
+
+/// @brief Concatenate the per-thread queues into `next`. Every thread copies its own part in parallel.
+static void MergeLocalQueues(const std::vector<std::vector<int>> &local, std::vector<int> &next){
+    std::vector<size_t> offset(local.size() + 1, 0);
+    for (size_t t = 0; t < local.size(); t++) offset[t + 1] = offset[t] + local[t].size();
+    next.resize(offset.back());
+    #pragma omp parallel for schedule(static, 1) if (next.size() >= PARALLEL_THRESHOLD)
+    for (int t = 0; t < (int)local.size(); t++){
+        std::copy(local[t].begin(), local[t].end(), next.begin() + offset[t]);
+    }
+}
+
+/// @brief Level-synchronous breadth-first search with OpenMP. Each level expands the frontier in parallel into
+/// per-thread queues; a cell is claimed by whichever thread sets its parent first (compare-and-swap). Wide
+/// frontiers switch to bottom-up steps, where every unvisited cell looks for a parent in the frontier and no
+/// atomics are needed. Returns a shortest path in the same format as AStarSeq.
+/// @param maze
+/// @return Vector of Cell from start to finish. {} if no path is found.
+std::vector<Cell *> ParallelBFS(Maze &maze){
+    if (!maze.start || !maze.finish) return {};
+
+    int num_cells = maze.width() * maze.height();
+    int start = maze.Index(maze.start);
+    int finish = maze.Index(maze.finish);
+    int num_threads = omp_get_max_threads();
+
+    std::vector<std::atomic<int>> parent(num_cells);    // -1 while unvisited, the start is its own parent
+    #pragma omp parallel for schedule(static)
+    for (int c = 0; c < num_cells; c++) parent[c].store(-1, std::memory_order_relaxed);
+    parent[start].store(start, std::memory_order_relaxed);
+
+    std::vector<int> frontier = { start };
+    std::vector<int> next;
+    std::vector<uint8_t> in_frontier;     // Frontier bitmap, only kept up to date during bottom-up steps
+    std::vector<std::vector<int>> local(num_threads);
+    long unvisited = num_cells - 1;
+    bool bottom_up = false;
+
+    while (!frontier.empty() && parent[finish].load(std::memory_order_relaxed) == -1){
+        if (!bottom_up && (long)frontier.size() * ALPHA > unvisited){
+            bottom_up = true;
+        } else if (bottom_up && (long)frontier.size() * BETA < num_cells){
+            bottom_up = false;
+        }
+        for (auto &queue : local) queue.clear();
+
+        if (bottom_up){
+            in_frontier.assign(num_cells, 0);
+            for (int c : frontier) in_frontier[c] = 1;
+            // Only this cell's own iteration writes its parent, so plain stores are enough
+            #pragma omp parallel
+            {
+                std::vector<int> &mine = local[omp_get_thread_num()];
+                #pragma omp for schedule(static)
+                for (int c = 0; c < num_cells; c++){
+                    if (parent[c].load(std::memory_order_relaxed) != -1) continue;
+                    uint8_t open = maze.OpenSides(c);
+                    for (int dir = 0; dir < 4; dir++){
+                        if (!(open & (1 << dir))) continue;
+                        int neighbour = maze.Neighbour(c, dir);
+                        if (in_frontier[neighbour]){
+                            parent[c].store(neighbour, std::memory_order_relaxed);
+                            mine.push_back(c);
+                            break;
+                        }
+                    }
+                }
+            }
+        } else {
+            #pragma omp parallel if (frontier.size() >= PARALLEL_THRESHOLD)
+            {
+                std::vector<int> &mine = local[omp_get_thread_num()];
+                #pragma omp for schedule(dynamic, 256)
+                for (size_t i = 0; i < frontier.size(); i++){
+                    int current = frontier[i];
+                    uint8_t open = maze.OpenSides(current);
+                    for (int dir = 0; dir < 4; dir++){
+                        if (!(open & (1 << dir))) continue;
+                        int neighbour = maze.Neighbour(current, dir);
+                        int unclaimed = -1;
+                        if (parent[neighbour].load(std::memory_order_relaxed) == -1
+                            && parent[neighbour].compare_exchange_strong(unclaimed, current, std::memory_order_relaxed)){
+                            mine.push_back(neighbour);
+                        }
+                    }
+                }
+            }
+        }
+
+        MergeLocalQueues(local, next);
+        unvisited -= next.size();
+        frontier.swap(next);
+    }
+
+    if (parent[finish].load() == -1) return {};
+
+    std::vector<Cell *> path = { maze.finish };
+    for (int current = finish; current != start; ){
+        current = parent[current].load(std::memory_order_relaxed);
+        path.push_back(maze.CellAt(current));
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
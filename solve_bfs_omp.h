@@ -0,0 +1,6 @@
+#pragma once
+#include "maze.h"
+
+#include <vector>
+
+std::vector<Cell *> ParallelBFS(Maze &maze);
@@ -0,0 +1,156 @@
+#include "solve_bidirectional.h"
+#include "maze.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// @brief Build start->finish path from the meeting cell and both parent arrays
+static std::vector<Cell *> JoinHalves(Maze &maze, int meet, const std::vector<int> &parent_fwd, const std::vector<int> &parent_bwd){
+    std::vector<Cell *> path;
+    for (int c = meet; c != -1; c = parent_fwd[c]){
+        path.push_back(maze.CellAt(c));
+    }
+    std::reverse(path.begin(), path.end());
+    for (int c = parent_bwd[meet]; c != -1; c = parent_bwd[c]){
+        path.push_back(maze.CellAt(c));
+    }
+    return path;
+}
+
+/// @brief Bidirectional breadth-first search. Expands whole levels from the smaller frontier until the two searches meet.
+/// Every step costs 1, so this returns a shortest path like AStarSeq.
+/// @param maze
+/// @return Vector of Cell from start to finish. {} if no path is found.
+std::vector<Cell *> BidirectionalSeq(Maze &maze){
+    if (!maze.start || !maze.finish) return {};
+    if (maze.start == maze.finish) return { maze.start };
+
+    int num_cells = maze.width() * maze.height();
+    std::vector<int> dist[2] = { std::vector<int>(num_cells, -1), std::vector<int>(num_cells, -1) };
+    std::vector<int> parent[2] = { std::vector<int>(num_cells, -1), std::vector<int>(num_cells, -1) };
+    std::vector<int> frontier[2];
+
+    int ends[2] = { maze.Index(maze.start), maze.Index(maze.finish) };
+    for (int side = 0; side < 2; side++){
+        dist[side][ends[side]] = 0;
+        frontier[side].push_back(ends[side]);
+    }
+
+    int best = std::numeric_limits<int>::max();
+    int meet = -1;
+    int reached[2] = { 0, 0 };  // All cells at distance <= reached[side] have been discovered from that side
+
+    while (!frontier[0].empty() && !frontier[1].empty()){
+        // Any path shorter than best would have been seen once the discovered radii cover it
+        if (reached[0] + reached[1] >= best - 1) break;
+
+        int side = frontier[0].size() <= frontier[1].size() ? 0 : 1;
+        int other = 1 - side;
+        std::vector<int> next;
+
+        for (int current : frontier[side]){
+            uint8_t open = maze.OpenSides(current);
+            for (int dir = 0; dir < 4; dir++){
+                if (!(open & (1 << dir))) continue;
+                int neighbour = maze.Neighbour(current, dir);
+                if (dist[side][neighbour] != -1) continue;
+
+                dist[side][neighbour] = dist[side][current] + 1;
+                parent[side][neighbour] = current;
+                next.push_back(neighbour);
+
+                if (dist[other][neighbour] != -1 && dist[side][neighbour] + dist[other][neighbour] < best){
+                    best = dist[side][neighbour] + dist[other][neighbour];
+                    meet = neighbour;
+                }
+            }
+        }
+
+        frontier[side].swap(next);
+        reached[side]++;
+    }
+
+    if (meet == -1) return {};
+    return JoinHalves(maze, meet, parent[0], parent[1]);
+}
+
+/// @brief Bidirectional BFS with the forward and backward searches on two threads.
+/// Each side owns its distance/parent arrays and publishes distances atomically, so either thread detects a meeting
+/// as soon as it discovers a cell the other side has already reached.
+/// @param maze
+/// @return Vector of Cell from start to finish. {} if no path is found.
+std::vector<Cell *> BidirectionalPar(Maze &maze){
+    if (!maze.start || !maze.finish) return {};
+    if (maze.start == maze.finish) return { maze.start };
+
+    int num_cells = maze.width() * maze.height();
+    std::vector<std::atomic<int>> dist[2] = { std::vector<std::atomic<int>>(num_cells), std::vector<std::atomic<int>>(num_cells) };
+    std::vector<int> parent[2] = { std::vector<int>(num_cells, -1), std::vector<int>(num_cells, -1) };
+    for (int side = 0; side < 2; side++){
+        for (std::atomic<int> &d : dist[side]) d.store(-1, std::memory_order_relaxed);
+    }
+
+    std::atomic<int> reached[2];
+    std::atomic<bool> exhausted(false);     // One side ran out of cells: no (better) path exists
+    std::atomic<int> best(std::numeric_limits<int>::max());
+    std::mutex meet_mutex;
+    int meet = -1;
+
+    int ends[2] = { maze.Index(maze.start), maze.Index(maze.finish) };
+    for (int side = 0; side < 2; side++){
+        dist[side][ends[side]].store(0);
+        reached[side].store(0);
+    }
+
+    auto search = [&](int side){
+        int other = 1 - side;
+        std::vector<int> frontier = { ends[side] };
+        std::vector<int> next;
+
+        while (!frontier.empty()){
+            // Read radii before best: a meeting is recorded before its side publishes the radius that produced it
+            int radius = reached[0].load() + reached[1].load();
+            if (exhausted.load() || radius >= best.load() - 1) return;
+
+            next.clear();
+            for (int current : frontier){
+                int current_dist = dist[side][current].load(std::memory_order_relaxed);
+                uint8_t open = maze.OpenSides(current);
+                for (int dir = 0; dir < 4; dir++){
+                    if (!(open & (1 << dir))) continue;
+                    int neighbour = maze.Neighbour(current, dir);
+                    if (dist[side][neighbour].load(std::memory_order_relaxed) != -1) continue;
+
+                    dist[side][neighbour].store(current_dist + 1);
+                    parent[side][neighbour] = current;
+                    next.push_back(neighbour);
+
+                    int other_dist = dist[other][neighbour].load();
+                    if (other_dist != -1){
+                        int total = current_dist + 1 + other_dist;
+                        std::lock_guard<std::mutex> lock(meet_mutex);
+                        if (total < best.load()){
+                            best.store(total);
+                            meet = neighbour;
+                        }
+                    }
+                }
+            }
+
+            frontier.swap(next);
+            reached[side].fetch_add(1);
+        }
+        exhausted.store(true);
+    };
+
+    std::thread backward(search, 1);
+    search(0);
+    backward.join();
+
+    if (meet == -1) return {};
+    return JoinHalves(maze, meet, parent[0], parent[1]);
+}
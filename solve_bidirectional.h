@@ -0,0 +1,7 @@
+#pragma once
+#include "maze.h"
+
+#include <vector>
+
+std::vector<Cell *> BidirectionalSeq(Maze &maze);
+std::vector<Cell *> BidirectionalPar(Maze &maze);
@@ -0,0 +1,203 @@
+#include "solve_bitboard.h"
+#include "maze.h"
+
+#include <algorithm>
+#include <immintrin.h>
+#include <memory>
+#include <vector>
+
+WallBitboard::WallBitboard(const Maze& maze){
+    words = ((maze.width() + 63) / 64 + 3) / 4 * 4;
+    stride = words + 2;
+    east.assign((size_t)stride * maze.height(), 0);
+    south.assign((size_t)stride * maze.height(), 0);
+    for (int y = 0; y < maze.height(); y++){
+        for (int x = 0; x < maze.width(); x++){
+            uint8_t open = maze.OpenSides(y * maze.width() + x);
+            size_t word = (size_t)y * stride + 1 + x / 64;
+            if (open & SIDE_EAST) east[word] |= 1ULL << (x % 64);
+            if (open & SIDE_SOUTH) south[word] |= 1ULL << (x % 64);
+        }
+    }
+}
+
+/// @brief Operands of one block expansion. A block is BLOCK_WORDS consecutive words of one row,
+/// and every pointer points at the first word of the block in its row.
+struct BlockExpand {
+    const uint64_t *frontier;       // Frontier of this row
+    const uint64_t *frontier_up;    // Frontier of the row above (zero row at the top)
+    const uint64_t *south_up;       // South walls of the row above
+    const uint64_t *frontier_down;  // Frontier of the row below (zero row at the bottom)
+    const uint64_t *south;          // South walls of this row
+    const uint64_t *east;           // East walls of this row
+    uint64_t *visited;              // Updated with the newly reached cells
+    uint64_t *next;                 // Output: cells of this block first reached at this level
+};
+
+static const int BLOCK_WORDS = 4;
+
+/// @brief Scalar block kernel: one BFS step into a block from all four directions
+/// @return True if any cell was reached
+static bool ExpandBlockScalar(const BlockExpand &block){
+    uint64_t any = 0;
+    for (int w = 0; w < BLOCK_WORDS; w++){
+        uint64_t from_west = ((block.frontier[w] & block.east[w]) << 1) | ((block.frontier[w - 1] & block.east[w - 1]) >> 63);
+        uint64_t from_east = ((block.frontier[w] >> 1) | (block.frontier[w + 1] << 63)) & block.east[w];
+        uint64_t from_north = block.frontier_up[w] & block.south_up[w];
+        uint64_t from_south = block.frontier_down[w] & block.south[w];
+        uint64_t reached = (from_west | from_east | from_north | from_south) & ~block.visited[w];
+        block.visited[w] |= reached;
+        block.next[w] = reached;
+        any |= reached;
+    }
+    return any != 0;
+}
+
+__attribute__((target("avx2")))
+static inline __m256i LoadWords(const uint64_t *p){
+    return _mm256_loadu_si256((const __m256i *)p);
+}
+
+/// @brief AVX2 block kernel, the whole block in one register. Same result as ExpandBlockScalar.
+__attribute__((target("avx2")))
+static bool ExpandBlockAVX2(const BlockExpand &block){
+    __m256i f = LoadWords(block.frontier);
+    __m256i e = LoadWords(block.east);
+    __m256i fe = _mm256_and_si256(f, e);
+    __m256i fe_prev = _mm256_and_si256(LoadWords(block.frontier - 1), LoadWords(block.east - 1));
+    __m256i from_west = _mm256_or_si256(_mm256_slli_epi64(fe, 1), _mm256_srli_epi64(fe_prev, 63));
+    __m256i f_next = LoadWords(block.frontier + 1);
+    __m256i from_east = _mm256_and_si256(_mm256_or_si256(_mm256_srli_epi64(f, 1), _mm256_slli_epi64(f_next, 63)), e);
+    __m256i from_north = _mm256_and_si256(LoadWords(block.frontier_up), LoadWords(block.south_up));
+    __m256i from_south = _mm256_and_si256(LoadWords(block.frontier_down), LoadWords(block.south));
+    __m256i reached = _mm256_or_si256(_mm256_or_si256(from_west, from_east), _mm256_or_si256(from_north, from_south));
+    __m256i visited = LoadWords(block.visited);
+    reached = _mm256_andnot_si256(visited, reached);
+    _mm256_storeu_si256((__m256i *)block.visited, _mm256_or_si256(visited, reached));
+    _mm256_storeu_si256((__m256i *)block.next, reached);
+    return !_mm256_testz_si256(reached, reached);
+}
+
+using BlockKernel = bool (*)(const BlockExpand &block);
+
+static BlockKernel SelectBlockKernel(){
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? ExpandBlockAVX2 : ExpandBlockScalar;
+}
+
+/// @brief Breadth-first flood fill on bit-packed walls. Each level advances every 256-cell block around the frontier
+/// in all four directions with shifts and masks (AVX2 when the CPU has it), then the path is backtracked
+/// through decreasing distances. Returns a shortest path in the same format as AStarSeq.
+/// @param maze
+/// @return Vector of Cell from start to finish. {} if no path is found.
+std::vector<Cell *> FloodFillBitboard(Maze &maze){
+    if (!maze.start || !maze.finish) return {};
+    if (maze.start == maze.finish) return { maze.start };
+
+    static const BlockKernel expand_block = SelectBlockKernel();
+
+    if (!maze.wall_bitboard){
+        maze.wall_bitboard = std::make_shared<const WallBitboard>(maze);
+    }
+    const WallBitboard &walls = *maze.wall_bitboard;
+    int height = maze.height();
+    int width = maze.width();
+    int blocks_x = walls.words / BLOCK_WORDS;
+    size_t stride = walls.stride;
+
+    // Row buffers, plus one zero row used above the top and below the bottom row
+    std::vector<uint64_t> frontier(stride * (height + 1), 0);
+    std::vector<uint64_t> next(stride * (height + 1), 0);
+    std::vector<uint64_t> visited(stride * height, 0);
+    const uint64_t *zero_row = frontier.data() + stride * height + 1;
+    std::vector<int> dist(width * height, -1);
+
+    int start = maze.Index(maze.start);
+    int finish = maze.Index(maze.finish);
+    size_t start_word = (start / width) * stride + 1 + (start % width) / 64;
+    frontier[start_word] |= 1ULL << (start % width % 64);
+    visited[start_word] |= 1ULL << (start % width % 64);
+    dist[start] = 0;
+
+    // Only blocks next to a block with frontier cells can gain cells, so each level touches
+    // a handful of blocks around the frontier instead of the whole maze
+    std::vector<int> active_blocks = { (start / width) * blocks_x + (start % width) / 64 / BLOCK_WORDS };
+    std::vector<int> next_blocks;
+    std::vector<int> block_stamp(height * blocks_x, -1);
+
+    for (int level = 1; !active_blocks.empty() && dist[finish] == -1; level++){
+        next_blocks.clear();
+        for (int active : active_blocks){
+            int active_y = active / blocks_x;
+            int active_b = active % blocks_x;
+            size_t active_word = active_y * stride + 1 + active_b * BLOCK_WORDS;
+            const uint64_t *f = frontier.data() + active_word;
+
+            // Skip neighbouring blocks the frontier of this block cannot step into
+            uint64_t to_north = 0, to_south = 0;
+            for (int w = 0; w < BLOCK_WORDS; w++){
+                if (active_y > 0) to_north |= f[w] & walls.south[active_word - stride + w];
+                to_south |= f[w] & walls.south[active_word + w];
+            }
+            const int candidates[5][3] = {
+                {active_y, active_b, 1},
+                {active_y, active_b - 1, (int)(f[0] & 1)},
+                {active_y, active_b + 1, (int)(f[BLOCK_WORDS - 1] >> 63)},
+                {active_y - 1, active_b, to_north != 0},
+                {active_y + 1, active_b, to_south != 0},
+            };
+            for (const auto &candidate : candidates){
+                int y = candidate[0];
+                int b = candidate[1];
+                if (!candidate[2] || y < 0 || y >= height || b < 0 || b >= blocks_x) continue;
+                int id = y * blocks_x + b;
+                if (block_stamp[id] == level) continue;
+                block_stamp[id] = level;
+
+                size_t word = y * stride + 1 + b * BLOCK_WORDS;
+                BlockExpand op;
+                op.frontier = frontier.data() + word;
+                op.frontier_up = y > 0 ? frontier.data() + word - stride : zero_row;
+                op.south_up = y > 0 ? walls.south.data() + word - stride : zero_row;
+                op.frontier_down = y < height - 1 ? frontier.data() + word + stride : zero_row;
+                op.south = walls.south.data() + word;
+                op.east = walls.east.data() + word;
+                op.visited = visited.data() + word;
+                op.next = next.data() + word;
+                if (!expand_block(op)) continue;
+
+                next_blocks.push_back(id);
+                for (int w = 0; w < BLOCK_WORDS; w++){
+                    for (uint64_t bits = op.next[w]; bits; bits &= bits - 1){
+                        dist[y * width + (b * BLOCK_WORDS + w) * 64 + __builtin_ctzll(bits)] = level;
+                    }
+                }
+            }
+        }
+
+        // Clear the old frontier blocks so the buffer can be reused for the level after next
+        for (int id : active_blocks){
+            size_t word = (id / blocks_x) * stride + 1 + (id % blocks_x) * BLOCK_WORDS;
+            std::fill(frontier.begin() + word, frontier.begin() + word + BLOCK_WORDS, 0);
+        }
+        frontier.swap(next);
+        active_blocks.swap(next_blocks);
+    }
+
+    if (dist[finish] == -1) return {};
+
+    std::vector<Cell *> path = { maze.finish };
+    for (int current = finish; current != start; ){
+        uint8_t open = maze.OpenSides(current);
+        for (int dir = 0; dir < 4; dir++){
+            int neighbour = maze.Neighbour(current, dir);
+            if ((open & (1 << dir)) && dist[neighbour] == dist[current] - 1){
+                current = neighbour;
+                break;
+            }
+        }
+        path.push_back(maze.CellAt(current));
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include "maze.h"
+
+#include <cstdint>
+#include <vector>
+
+/// @brief Walls of a maze packed as bit rows. Bit x of row y is set in `east` if cell (x, y) has its east side open,
+/// and in `south` if its south side is open. Every row has one zero padding word on each side, so kernels can read
+/// the neighbouring words of any real word without bounds checks.
+struct WallBitboard {
+    explicit WallBitboard(const Maze& maze);
+
+    int words;      // Real words per row, rounded up to a multiple of 4 (one AVX2 register)
+    int stride;     // words + 2 padding words
+    std::vector<uint64_t> east;
+    std::vector<uint64_t> south;
+};
+
+std::vector<Cell *> FloodFillBitboard(Maze &maze);
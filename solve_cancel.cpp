@@ -0,0 +1,52 @@
+#include "solve_cancel.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+static std::atomic<bool> armed(false);
+static std::atomic<bool> cancelled(false);
+static std::atomic<int64_t> deadline_ns(0);    // steady_clock time, 0 for no timeout
+
+static int64_t NowNs(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// @brief Start accepting a cancel for the solve about to run
+/// @param timeout_ms Stop the solve after this long, <= 0 for no timeout
+void ArmSolveCancel(double timeout_ms){
+    cancelled = false;
+    deadline_ns = timeout_ms > 0 ? NowNs() + (int64_t)(timeout_ms * 1e6) : 0;
+    armed = true;
+}
+
+/// @brief Ask the running solve to stop. Safe from any thread.
+/// @return False if no solve is running
+bool CancelSolve(){
+    if (!armed) return false;
+    cancelled = true;
+    return true;
+}
+
+void DisarmSolveCancel(){
+    armed = false;
+    cancelled = false;
+    deadline_ns = 0;
+}
+
+/// @brief True once the armed solve was cancelled or ran past its timeout. Cheap enough to call every search round.
+bool SolveCancelRequested(){
+    if (!armed) return false;
+    if (cancelled) return true;
+    int64_t deadline = deadline_ns;
+    return deadline != 0 && NowNs() >= deadline;
+}
+
+/// @brief Why the armed solve stopped: "cancelled", "timeout", or "" if it was not stopped
+std::string SolveCancelReason(){
+    if (!armed) return "";
+    if (cancelled) return "cancelled";
+    int64_t deadline = deadline_ns;
+    if (deadline != 0 && NowNs() >= deadline) return "timeout";
+    return "";
+}
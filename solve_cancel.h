@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string>
+
+// Cooperative stop of a running solve. The web server (rank 0) arms it around /solve with an optional timeout, and
+// /cancel can trip it from another handler thread. Solvers poll SolveCancelRequested between units of work; the
+// other MPI ranks are never armed and learn about a stop from rank 0 (see SolveSelected).
+
+void ArmSolveCancel(double timeout_ms);
+bool CancelSolve();
+void DisarmSolveCancel();
+bool SolveCancelRequested();
+std::string SolveCancelReason();
@@ -0,0 +1,113 @@
+#include "solve_lanes.h"
+#include "maze.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+static const int LANES = 64;
+
+/// @brief Breadth-first search of up to 64 same-sized mazes at once. Every cell holds one 64-bit word per
+/// state (walls, visited, frontier, parent direction) with bit k belonging to maze k, so one word operation
+/// advances the search of all lanes. Appends one shortest path per maze to `paths`.
+/// @param batch Up to 64 mazes, all with the same width and height
+/// @param paths Output, one path per maze of the batch
+static void SolveLaneBatch(std::vector<Maze *> &batch, PathSet &paths){
+    int width = batch[0]->width();
+    int height = batch[0]->height();
+    int stride = width + 2;     // One zero cell of padding around the grid, so neighbours need no bounds checks
+    int padded = stride * (height + 2);
+    auto padded_of = [&](int cell){ return (cell / width + 1) * stride + cell % width + 1; };
+
+    std::vector<uint64_t> east(padded, 0), south(padded, 0);
+    std::vector<uint64_t> visited(padded, 0), frontier(padded, 0), next(padded, 0);
+    std::vector<uint64_t> parent_bit0(padded, 0), parent_bit1(padded, 0);   // 2-bit direction towards the parent, per lane
+
+    uint64_t remaining = 0;     // Lanes whose finish has not been reached
+    std::vector<int> starts(batch.size()), finishes(batch.size());
+    for (size_t lane = 0; lane < batch.size(); lane++){
+        Maze &maze = *batch[lane];
+        uint64_t bit = 1ULL << lane;
+        for (int c = 0; c < width * height; c++){
+            uint8_t open = maze.OpenSides(c);
+            if (open & SIDE_EAST) east[padded_of(c)] |= bit;
+            if (open & SIDE_SOUTH) south[padded_of(c)] |= bit;
+        }
+        if (!maze.start || !maze.finish) continue;
+        starts[lane] = padded_of(maze.Index(maze.start));
+        finishes[lane] = padded_of(maze.Index(maze.finish));
+        visited[starts[lane]] |= bit;
+        frontier[starts[lane]] |= bit;
+        if (starts[lane] != finishes[lane]) remaining |= bit;
+    }
+
+    while (remaining){
+        uint64_t any = 0;
+        for (int y = 1; y <= height; y++){
+            for (int p = y * stride + 1; p <= y * stride + width; p++){
+                uint64_t from_west = frontier[p - 1] & east[p - 1];
+                uint64_t from_east = frontier[p + 1] & east[p];
+                uint64_t from_north = frontier[p - stride] & south[p - stride];
+                uint64_t from_south = frontier[p + stride] & south[p];
+                uint64_t reached = (from_west | from_east | from_north | from_south) & ~visited[p];
+
+                // Pick one parent per lane, preferring west (2), then east (0), north (3), south (1).
+                // The codes are the dir numbering of Maze::Neighbour, so east leaves both bits clear.
+                uint64_t west = reached & from_west;
+                uint64_t north = reached & ~from_west & ~from_east & from_north;
+                uint64_t south_only = reached & ~from_west & ~from_east & ~from_north;
+                parent_bit0[p] |= north | south_only;
+                parent_bit1[p] |= west | north;
+
+                visited[p] |= reached;
+                next[p] = reached;
+                any |= reached;
+            }
+        }
+        frontier.swap(next);
+        if (!any) break;    // Remaining lanes have no path
+
+        for (uint64_t lanes = remaining; lanes; lanes &= lanes - 1){
+            int lane = __builtin_ctzll(lanes);
+            if (visited[finishes[lane]] & (1ULL << lane)) remaining &= ~(1ULL << lane);
+        }
+    }
+
+    // Follow the parent directions back from each finish
+    const int step[4] = { 1, stride, -1, -stride };
+    std::vector<int32_t> path;
+    for (size_t lane = 0; lane < batch.size(); lane++){
+        Maze &maze = *batch[lane];
+        path.clear();
+        if (maze.start && maze.finish && (visited[finishes[lane]] >> lane & 1)){
+            for (int p = finishes[lane]; ; ){
+                path.push_back((p / stride - 1) * width + p % stride - 1);
+                if (p == starts[lane]) break;
+                int dir = (int)(parent_bit0[p] >> lane & 1) | (int)(parent_bit1[p] >> lane & 1) << 1;
+                p += step[dir];
+            }
+            std::reverse(path.begin(), path.end());
+        }
+        paths.Append(width, path.data(), path.size());
+    }
+}
+
+/// @brief Solve mazes[begin, end) in batches of up to 64 consecutive mazes of equal size
+/// @return Paths in maze order
+PathSet SolveLanes(std::vector<Maze> &mazes, int begin, int end){
+    PathSet paths;
+    std::vector<Maze *> batch;
+    for (int i = begin; i < end; i++){
+        batch.push_back(&mazes[i]);
+        bool full = (int)batch.size() == LANES;
+        bool last = i + 1 == end;
+        bool size_changes = !last && (mazes[i + 1].width() != mazes[i].width() || mazes[i + 1].height() != mazes[i].height());
+        if (full || last || size_changes){
+            TraceSpan span("solve", i - (int)batch.size() + 1);
+            SolveLaneBatch(batch, paths);
+            batch.clear();
+        }
+    }
+    return paths;
+}
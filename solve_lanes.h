@@ -0,0 +1,7 @@
+#pragma once
+#include "maze.h"
+#include "path_set.h"
+
+#include <vector>
+
+PathSet SolveLanes(std::vector<Maze> &mazes, int begin, int end);
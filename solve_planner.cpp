@@ -0,0 +1,408 @@
+#include "solve_planner.h"
+#include "solve_a_star.h"
+#include "maze_collection.h"
+
+#include "omp.h"
+#ifdef USE_MPI
+#include "mpi.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+static SolveCostModel model;
+static SolvePlan last_plan;
+
+// Calibration batches: square mazes of each side, as many as fit in about the same number of cells
+static const uint32_t CALIBRATION_SEED = 12345;
+static const int COST_SIDE[COST_SIDES] = { 8, 24, 64, 128 };
+static const int BATCH_CELLS = 32 * 1024;
+static const int INTRA_BATCH_CELLS = 4 * 1024;
+static const int THREAD_SIDE = 32;
+// Mazes per thread in a rank's share, tens of ms so ranks sharing a core are preempted instead of finishing in one time slice
+static const int RANK_SHARE_MAZES = 256;
+static const char* const ALGORITHMS[SOLVE_ALGORITHMS] = { "astar", "bidir", "bidir_par", "junction", "hpa", "bitboard", "lanes" };
+static const char* const KIND_NAMES[MAZE_KINDS] = { "perfect", "braided", "weighted" };
+// The first run is cold (page faults, allocator growth), every measurement keeps the faster of two
+static const int REPEATS = 2;
+
+static double MsSince(std::chrono::steady_clock::time_point t0){
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+/// @brief Piecewise linear in the cells between the measured sides, extended with the first and last segment
+double CostCurve::MazeMs(double cells) const {
+    int segment = 0;
+    while (segment + 2 < COST_SIDES && cells > (double)COST_SIDE[segment + 1] * COST_SIDE[segment + 1]) segment++;
+    double cells0 = (double)COST_SIDE[segment] * COST_SIDE[segment];
+    double cells1 = (double)COST_SIDE[segment + 1] * COST_SIDE[segment + 1];
+    double ms = maze_ms[segment] + (maze_ms[segment + 1] - maze_ms[segment]) * (cells - cells0) / (cells1 - cells0);
+    // Below the smallest side, no less than the smallest maze scaled down
+    return std::max(ms, maze_ms[0] * std::min(1.0, cells / cells0));
+}
+
+/// @brief Generator options of a calibration batch of the kind, the ones of a typical braided / weighted request
+static MazeOptions KindOptions(MazeKind kind){
+    MazeOptions options;
+    if (kind != MazeKind::Perfect) options.braid = 0.2;
+    if (kind == MazeKind::Weighted) options.max_weight = 5;
+    return options;
+}
+
+static MazeKind KindOf(const MazeOptions& options){
+    if (options.max_weight > 1) return MazeKind::Weighted;
+    return options.braid > 0 ? MazeKind::Braided : MazeKind::Perfect;
+}
+
+/// @brief Index of the algorithm in SolveCostModel::solve, A* for unknown names
+static int AlgorithmIndex(const std::string& algorithm){
+    for (int a = 0; a < SOLVE_ALGORITHMS; a++){
+        if (algorithm == ALGORITHMS[a]) return a;
+    }
+    return 0;
+}
+
+/// @brief Mazes in a calibration batch of the side, at least two so one odd path does not set the cost
+static int BatchCount(int side, int batch_cells){
+    return std::max(2, batch_cells / (side * side));
+}
+
+/// @brief Drop the junction graphs, HPA graphs and bitboards, so the next solve pays for building them as a
+/// fresh batch does
+static void DropSolverCaches(const std::vector<MazeCollection::Page>& pages){
+    for (const MazeCollection::Page& page : pages){
+        for (Maze& maze : *page){
+            maze.junction_graph.reset();
+            maze.hpa_graph.reset();
+            maze.wall_bitboard.reset();
+        }
+    }
+}
+
+/// @brief Time materializing the batch (fastest of REPEATS fresh batches), leaving the last one materialized in pinned
+static double TimeGenerate(MazeCollection& mazes, int side, int count, MazeKind kind, std::vector<MazeCollection::Page>& pinned){
+    double best_ms = 0;
+    for (int r = 0; r < REPEATS; r++){
+        pinned.clear();
+        mazes.Reset(side, side, count, CALIBRATION_SEED, KindOptions(kind));
+        auto t0 = std::chrono::steady_clock::now();
+        for (int page = 0; page < mazes.NumPages(); page++) pinned.push_back(mazes.GetPage(page));
+        double ms = MsSince(t0);
+        if (r == 0 || ms < best_ms) best_ms = ms;
+    }
+    return best_ms;
+}
+
+/// @brief Time solving the materialized batch with the algorithm on this thread, the way sequential mode does
+static double TimeSolve(MazeCollection& mazes, const std::vector<MazeCollection::Page>& pinned, const char* algorithm, PathSet& paths){
+    BatchSolver solver = BatchSolverForAlgorithm(algorithm, SearchHeuristic::Manhattan);
+    double best_ms = 0;
+    for (int r = 0; r < REPEATS; r++){
+        DropSolverCaches(pinned);
+        auto t0 = std::chrono::steady_clock::now();
+        paths = SolveSeq(mazes, solver);
+        double ms = MsSince(t0);
+        if (r == 0 || ms < best_ms) best_ms = ms;
+    }
+    return best_ms;
+}
+
+#if defined(USE_MPI) || defined(USE_OMP)
+/// @brief Speedup of the OpenMP team over one thread on independent, already materialized mazes
+static double MeasureThreadSpeedup(){
+    int threads = omp_get_max_threads();
+    if (threads <= 1) return 1;
+    MazeCollection mazes;
+    mazes.Reset(THREAD_SIDE, THREAD_SIDE, threads * 8, CALIBRATION_SEED, MazeOptions());
+    std::vector<std::shared_ptr<Maze>> pinned;
+    for (int i = 0; i < mazes.size(); i++) pinned.push_back(mazes.Get(i));
+
+    double serial_ms = 0, parallel_ms = 0;
+    for (int r = 0; r < REPEATS; r++){
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < (int)pinned.size(); i++) AStarSeq(*pinned[i]);
+        double ms = MsSince(t0);
+        if (r == 0 || ms < serial_ms) serial_ms = ms;
+        t0 = std::chrono::steady_clock::now();
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int i = 0; i < (int)pinned.size(); i++) AStarSeq(*pinned[i]);
+        ms = MsSince(t0);
+        if (r == 0 || ms < parallel_ms) parallel_ms = ms;
+    }
+    return std::max(1.0, std::min((double)threads, serial_ms / std::max(parallel_ms, 1e-6)));
+}
+
+/// @brief Time the intra-maze solver on a materialized batch (fastest of REPEATS). Collective under MPI.
+static double TimeIntra(MazeCollection& mazes){
+    double best_ms = 0;
+    for (int r = 0; r < REPEATS; r++){
+    #ifdef USE_MPI
+        MPI_Barrier(MPI_COMM_WORLD);
+    #endif
+        auto t0 = std::chrono::steady_clock::now();
+        SolveIntraMaze(mazes);
+        double ms = MsSince(t0);
+        if (r == 0 || ms < best_ms) best_ms = ms;
+    }
+    return best_ms;
+}
+#endif
+
+/// @brief Run fn on rank 0 while the other ranks sleep, so they do not compete for its cores. Collective under MPI.
+static void OnRootAlone(const std::function<void()>& fn){
+#ifdef USE_MPI
+    int my_rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &my_rank);
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (my_rank == 0) fn();
+    MPI_Request request;
+    MPI_Ibarrier(MPI_COMM_WORLD, &request);
+    int done = 0;
+    MPI_Test(&request, &done, MPI_STATUS_IGNORE);
+    while (!done){
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        MPI_Test(&request, &done, MPI_STATUS_IGNORE);
+    }
+#else
+    fn();
+#endif
+}
+
+#ifdef USE_MPI
+/// @brief Speedup of every rank solving a share at once over rank 0 solving it alone, with their OpenMP teams: the
+/// rank count on dedicated cores, less when ranks share cores or memory bandwidth
+static double MeasureRankSpeedup(){
+    int my_rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &my_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (size <= 1) return 1;
+    MazeCollection mazes;
+    mazes.Reset(THREAD_SIDE, THREAD_SIDE, omp_get_max_threads() * RANK_SHARE_MAZES, CALIBRATION_SEED, MazeOptions());
+    std::vector<std::shared_ptr<Maze>> pinned;
+    for (int i = 0; i < mazes.size(); i++) pinned.push_back(mazes.Get(i));
+    auto solve_share = [&pinned](){
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int i = 0; i < (int)pinned.size(); i++) AStarSeq(*pinned[i]);
+    };
+
+    double alone_ms = 0, together_ms = 0;
+    for (int r = 0; r < REPEATS; r++){
+        OnRootAlone([&](){
+            auto t0 = std::chrono::steady_clock::now();
+            solve_share();
+            double ms = MsSince(t0);
+            if (r == 0 || ms < alone_ms) alone_ms = ms;
+        });
+        MPI_Barrier(MPI_COMM_WORLD);
+        auto t0 = std::chrono::steady_clock::now();
+        solve_share();
+        double ms = MsSince(t0);
+        MPI_Allreduce(MPI_IN_PLACE, &ms, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        if (r == 0 || ms < together_ms) together_ms = ms;
+    }
+    double speedup = std::max(1.0, std::min((double)size, size * alone_ms / std::max(together_ms, 1e-6)));
+    MPI_Bcast(&speedup, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    return speedup;
+}
+
+/// @brief Average time of a Gatherv to rank 0 with `bytes` from every other rank
+static double TimeGather(int bytes){
+    int my_rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &my_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    std::vector<uint8_t> send(my_rank == 0 ? 0 : bytes);
+    std::vector<int> sizes(size, bytes);
+    std::vector<int> displacements(size + 1, 0);
+    sizes[0] = 0;
+    for (int rank = 0; rank < size; rank++) displacements[rank + 1] = displacements[rank] + sizes[rank];
+    std::vector<uint8_t> received(my_rank == 0 ? displacements[size] : 0);
+
+    const int repeats = 8;
+    MPI_Barrier(MPI_COMM_WORLD);
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++){
+        MPI_Gatherv(send.data(), (int)send.size(), MPI_BYTE, received.data(), sizes.data(), displacements.data(), MPI_BYTE, 0, MPI_COMM_WORLD);
+    }
+    return MsSince(t0) / repeats;
+}
+
+static_assert(sizeof(CostCurve) == COST_SIDES * sizeof(double), "CostCurves are sent as plain doubles");
+
+static void BroadcastCurves(CostCurve* curves, int count){
+    MPI_Bcast(curves[0].maze_ms, count * COST_SIDES, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+}
+#endif
+
+/// @brief Generation and every algorithm on one thread, on perfect, braided and weighted mazes of each side, and the
+/// OpenMP team's speedup
+static void MeasureSerialCosts(){
+    for (int kind = 0; kind < MAZE_KINDS; kind++){
+        for (int s = 0; s < COST_SIDES; s++){
+            int side = COST_SIDE[s];
+            int count = BatchCount(side, BATCH_CELLS);
+            MazeCollection mazes;
+            std::vector<MazeCollection::Page> pinned;
+            model.generate[kind].maze_ms[s] = TimeGenerate(mazes, side, count, (MazeKind)kind, pinned) / count;
+            for (int a = 0; a < SOLVE_ALGORITHMS; a++){
+                PathSet paths;
+                model.solve[a][kind].maze_ms[s] = TimeSolve(mazes, pinned, ALGORITHMS[a], paths) / count;
+                if (a == 0 && kind == (int)MazeKind::Perfect && s == COST_SIDES - 1){
+                    model.path_steps_per_side = paths.TotalCells() / (double)count / (2.0 * side);
+                }
+            }
+        }
+    }
+#if defined(USE_MPI) || defined(USE_OMP)
+    model.thread_speedup = MeasureThreadSpeedup();
+#endif
+}
+
+static void PrintCurves(const char* name, const CostCurve* curves){
+    printf("  %-10s", name);
+    for (int kind = 0; kind < MAZE_KINDS; kind++){
+        printf(kind == 0 ? " " : " | ");
+        for (int s = 0; s < COST_SIDES; s++) printf(s == 0 ? "%.3g" : "/%.3g", curves[kind].maze_ms[s] * 1000);
+    }
+    printf("\n");
+}
+
+/// @brief Fill the cost model with a short micro-run (around a second). Collective under MPI: every rank calls it once
+/// at startup. Rank 0 measures the single-process costs alone and sends them to the others, the intra solver, gather
+/// and rank speedup are measured with all ranks, so every rank makes the same "auto" decisions.
+void CalibrateSolvePlanner(){
+    OnRootAlone(MeasureSerialCosts);
+
+#if defined(USE_MPI) || defined(USE_OMP)
+    for (int kind = 0; kind < MAZE_KINDS; kind++){
+        for (int s = 0; s < COST_SIDES; s++){
+            int side = COST_SIDE[s];
+            int count = BatchCount(side, INTRA_BATCH_CELLS);
+            MazeCollection mazes;
+            mazes.Reset(side, side, count, CALIBRATION_SEED, KindOptions((MazeKind)kind));
+            std::vector<MazeCollection::Page> pinned;
+            for (int page = 0; page < mazes.NumPages(); page++) pinned.push_back(mazes.GetPage(page));
+            model.intra[kind].maze_ms[s] = TimeIntra(mazes) / count;
+        }
+    }
+#endif
+
+#ifdef USE_MPI
+    int my_rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &my_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    BroadcastCurves(model.generate, MAZE_KINDS);
+    BroadcastCurves(model.solve[0], SOLVE_ALGORITHMS * MAZE_KINDS);
+    double serial[] = { model.thread_speedup, model.path_steps_per_side };
+    MPI_Bcast(serial, sizeof(serial) / sizeof(serial[0]), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    model.thread_speedup = serial[0];
+    model.path_steps_per_side = serial[1];
+    // Intra runs on every rank and finishes with the slowest one
+    MPI_Allreduce(MPI_IN_PLACE, model.intra[0].maze_ms, MAZE_KINDS * COST_SIDES, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+    if (size > 1){
+        const int small_bytes = 16;
+        const int large_bytes = 64 * 1024;
+        double small_gather_ms = TimeGather(small_bytes);
+        double large_gather_ms = TimeGather(large_bytes);
+        double extra_bytes = (double)(large_bytes - small_bytes) * (size - 1);
+        model.gather_ns_per_byte = std::max(0.0, (large_gather_ms - small_gather_ms) * 1e6 / extra_bytes);
+        model.gather_us = small_gather_ms * 1000;
+        double gather[] = { model.gather_us, model.gather_ns_per_byte };
+        MPI_Bcast(gather, 2, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        model.gather_us = gather[0];
+        model.gather_ns_per_byte = gather[1];
+    }
+    model.rank_speedup = MeasureRankSpeedup();
+    if (my_rank != 0) return;
+#endif
+    printf("Solve cost model, us per maze at sides %d/%d/%d/%d (%s | %s | %s):\n", COST_SIDE[0], COST_SIDE[1], COST_SIDE[2], COST_SIDE[3],
+        KIND_NAMES[0], KIND_NAMES[1], KIND_NAMES[2]);
+    PrintCurves("generate", model.generate);
+    for (int a = 0; a < SOLVE_ALGORITHMS; a++) PrintCurves(ALGORITHMS[a], model.solve[a]);
+#if defined(USE_MPI) || defined(USE_OMP)
+    PrintCurves("intra", model.intra);
+#endif
+    printf("  %.1fx thread speedup, %.1fx rank speedup, gather %.1f us + %.2f ns/byte\n", model.thread_speedup, model.rank_speedup,
+        model.gather_us, model.gather_ns_per_byte);
+}
+
+const SolveCostModel& GetSolveCostModel(){
+    return model;
+}
+
+/// @brief Predict the time of every solve mode on this build and world size and pick the fastest, from the costs of
+/// the requested algorithm on the batch's kind of maze. Mazes that are not materialized yet are charged their
+/// generation. Collective under MPI (the ranks agree on the uncached counts), so every rank picks the same mode.
+/// Intra mode ignores the algorithm, so it is only a candidate for "astar".
+SolvePlan PlanSolve(const MazeCollection& mazes, const std::string& algorithm){
+    int num_mazes = mazes.size();
+    double cells = (double)mazes.width() * mazes.height();
+    int kind = (int)KindOf(mazes.Options());
+    double generate_ms = model.generate[kind].MazeMs(cells);
+    double solve_ms = model.solve[AlgorithmIndex(algorithm)][kind].MazeMs(cells);
+
+    int size = 1;
+    int my_rank = 0;
+#ifdef USE_MPI
+    MPI_Comm_rank(MPI_COMM_WORLD, &my_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+#endif
+    // Sequential and intra need the whole batch on every rank, inter only the rank's share (see SolveMPI)
+    int per_rank = (num_mazes + size - 1) / size;
+    int share_begin = std::min(num_mazes, my_rank * per_rank);
+    int share_end = std::min(num_mazes, share_begin + per_rank);
+    int uncached[] = { num_mazes - mazes.CachedMazes(0, num_mazes), (share_end - share_begin) - mazes.CachedMazes(share_begin, share_end) };
+#ifdef USE_MPI
+    MPI_Allreduce(MPI_IN_PLACE, uncached, 2, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+#endif
+
+    // Every rank works at once in sequential (each solves the whole batch) and inter mode, and ranks that share cores
+    // slow each other down
+    double contention = size / model.rank_speedup;
+
+    SolvePlan plan;
+    plan.sequential_ms = (uncached[0] * generate_ms + num_mazes * solve_ms) * contention;
+#if defined(USE_MPI) || defined(USE_OMP)
+    int threads = omp_get_max_threads();
+    // A share smaller than the team only keeps part of it busy. Pages are materialized serially.
+    double speedup = 1;
+    if (threads > 1) speedup = 1 + (model.thread_speedup - 1) * (std::min(threads, per_rank) - 1) / (threads - 1);
+    plan.inter_ms = (uncached[1] * generate_ms + per_rank * solve_ms / speedup) * contention;
+    if (size > 1){
+        // Compact path: 8 byte header + 2 bits per step
+        double path_bytes = 8 + model.path_steps_per_side * (mazes.width() + mazes.height()) / 4;
+        plan.inter_ms += (model.gather_us + num_mazes * path_bytes * model.gather_ns_per_byte / 1000) / 1000;
+    }
+    // The intra solvers (HDA, the OpenMP BFS) are A* searches, so they only stand in for a caller asking for A*
+    if (algorithm == "astar") plan.intra_ms = uncached[0] * generate_ms + num_mazes * model.intra[kind].MazeMs(cells);
+#endif
+
+    plan.mode = "sequential";
+    plan.predicted_ms = plan.sequential_ms;
+    if (plan.inter_ms >= 0 && plan.inter_ms < plan.predicted_ms){
+        plan.mode = "inter";
+        plan.predicted_ms = plan.inter_ms;
+    }
+    if (plan.intra_ms >= 0 && plan.intra_ms < plan.predicted_ms){
+        plan.mode = "intra";
+        plan.predicted_ms = plan.intra_ms;
+    }
+    return plan;
+}
+
+void RecordSolvePlan(const SolvePlan& plan){
+    last_plan = plan;
+}
+
+/// @brief The plan of the last "auto" solve, and forget it. Empty mode if there was none.
+SolvePlan TakeSolvePlan(){
+    SolvePlan plan = last_plan;
+    last_plan = SolvePlan();
+    return plan;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "maze_collection.h"
+
+#include <string>
+
+// Maze sides the costs are measured at (see CostCurve)
+static const int COST_SIDES = 4;
+// Maze kinds with their own costs (see MazeKind)
+static const int MAZE_KINDS = 3;
+// Algorithms of the "algorithm" parameter, each with its own solve costs
+static const int SOLVE_ALGORITHMS = 7;
+
+/// @brief Time per maze of one kind of work, measured on batches of square mazes of a few sides and interpolated by
+/// the cell count in between. The fixed cost dominates small mazes and cache misses large ones, so one
+/// per-maze + per-cell line fits neither end.
+struct CostCurve {
+    double maze_ms[COST_SIDES] = {};
+    double MazeMs(double cells) const;
+};
+
+/// @brief Loops change how much of the maze a search explores, and the BFS-based solvers fall back to A* on weights
+enum class MazeKind : int {
+    Perfect = 0,
+    Braided,    // Loops, unweighted
+    Weighted,   // Loops and weights
+};
+
+/// @brief Measured costs the solve planner predicts with. Filled by CalibrateSolvePlanner at startup.
+struct SolveCostModel {
+    CostCurve generate[MAZE_KINDS];                 // Materializing one maze
+    CostCurve solve[SOLVE_ALGORITHMS][MAZE_KINDS];  // Solving one materialized maze on one thread, preprocessing included
+    CostCurve intra[MAZE_KINDS];                    // Solving one maze with the intra-maze solver (HDA or the OpenMP BFS)
+    double thread_speedup = 1;      // Speedup of the whole OpenMP team on independent mazes
+    double rank_speedup = 1;        // Speedup of all ranks working at once over one alone, below the rank count on shared cores
+    double gather_us = 20;          // Latency of gathering paths on rank 0
+    double gather_ns_per_byte = 1;
+    double path_steps_per_side = 1; // Path length / (width + height)
+};
+
+/// @brief Strategy picked by the "auto" mode, with the predicted time of every candidate (negative if not available
+/// in this build or for the requested algorithm) and, after the solve, the measured one
+struct SolvePlan {
+    std::string mode;
+    double sequential_ms = -1;
+    double inter_ms = -1;
+    double intra_ms = -1;
+    double predicted_ms = 0;
+    double actual_ms = -1;
+};
+
+void CalibrateSolvePlanner();
+const SolveCostModel& GetSolveCostModel();
+SolvePlan PlanSolve(const MazeCollection& mazes, const std::string& algorithm = "astar");
+void RecordSolvePlan(const SolvePlan& plan);
+SolvePlan TakeSolvePlan();
@@ -2,10 +2,16 @@
 const ZOOM_MIN = 1;
 const ZOOM_MAX = 500;
 const ZOOM_STEP = 1;
-const fmtMs = (v) => Number.isFinite(v) ? v.toFixed(2) : '-';
+const fmtMs = (v) => v !== null && v !== undefined && Number.isFinite(Number(v)) ? Number(v).toFixed(2) : '-';
 
+// Mazes and paths are fetched per index when shown (null until then); batchInfo holds the batch parameters
+const TILE_SIZE = 256;
+const TILE_CELLS_THRESHOLD = 200 * 200;     // Larger mazes are drawn from server-rendered tiles
+const TILE_COLORS = [[0x1e, 0x1e, 0x1e, 255], [255, 255, 255, 255], [0x26, 0xa4, 0xa6, 255], [0, 0, 0, 0]];   // Floor, wall, path, outside
+let batchInfo = null;
 let mazeDataArr = [];
 let pathDataArr = [];
+let tileCache = new Map();
 let currentMazeIdx = 0;
 let runCount = 0;
 let results = [];
@@ -32,29 +38,34 @@ async function onBtnGenerateClick() {
     }
 
     const mazesToGenerate = Number(document.getElementById('numMazes').value);
+    const braid = Number(document.getElementById('braidInput').value) || 0;
+    const maxWeight = Number(document.getElementById('maxWeightInput').value) || 1;
 
     try {
         // HTTP POST to trigger generation, then GET to fetch data
-        const res = await fetch('/generate?width=' + width + '&height=' + height + '&numMazes=' + mazesToGenerate, { method: 'POST' });
+        const res = await fetch('/generate?width=' + width + '&height=' + height + '&numMazes=' + mazesToGenerate + '&braid=' + braid + '&maxWeight=' + maxWeight + '&lazy=1', { method: 'POST' });
         if (!res.ok) {
             throw new Error('Generate request failed with status ' + res.status);
         }
 
         const data = await res.json();
-        mazeDataArr = data.mazes || [data];
-        pathDataArr = new Array(mazeDataArr.length).fill(null);
+        batchInfo = data;
+        mazeDataArr = new Array(data.numMazes).fill(null);
+        pathDataArr = new Array(data.numMazes).fill(null);
+        tileCache = new Map();
+        currentMazeIdx = 0;
 
         pendingResultIndexes = [];
-        for (let i = 0; i < mazeDataArr.length; i++) {
+        for (let i = 0; i < data.numMazes; i++) {
             runCount++;
             results.push({
                 id: runCount,
                 gen: generator,
                 algo: 'Pending',
-                w: mazeDataArr[i].width,
-                h: mazeDataArr[i].height,
-                cells: mazeDataArr[i].width * mazeDataArr[i].height,
-                genMs: Number(mazeDataArr[i].generationTime) ?? data.generationTime / mazeDataArr.length,
+                w: data.width,
+                h: data.height,
+                cells: data.width * data.height,
+                genMs: null,      // Lazy batch: mazes are generated during the solve, which reports the time
                 solveMs: null,
                 pathLen: null,
                 efficiency: null
@@ -62,7 +73,7 @@ async function onBtnGenerateClick() {
             pendingResultIndexes.push(results.length - 1);
         }
 
-        document.getElementById('genInfo').textContent = `Generated ${width}x${height} maze(s) in ${fmtMs(Number(data.generationTime))} ms.`;
+        document.getElementById('genInfo').textContent = `Created ${data.numMazes} maze(s) of ${data.width}x${data.height}, generated on demand.`;
         document.getElementById('btnSolve').disabled = false;
         RenderResults();
         RenderMazeScroll();
@@ -78,42 +89,62 @@ document.getElementById('btnGenerate').onclick = onBtnGenerateClick;
 document.getElementById('btnSolve').onclick = async () => {
     const algorithm = document.getElementById('algorithmSelect').value;
     const mode = document.getElementById('modeSelect').value;
+    const heuristic = document.getElementById('heuristicSelect').value;
     const algorithmName = document.getElementById('algorithmSelect').selectedOptions[0].text
     const generatorName = document.getElementById('generatorSelect').selectedOptions[0].text;
     // HTTP POST to trigger solving, then GET to fetch solution
-    const res = await fetch('/solve?algorithm=' + algorithm + '&mode=' + mode, { method: 'POST' });
+    // Only the path lengths come back, the paths are fetched with the mazes that are shown
+    const timeoutMs = parseFloat(document.getElementById('timeoutInput').value) || 0;
+    const btnCancel = document.getElementById('btnCancel');
+    btnCancel.disabled = false;
+    const res = await fetch('/solve?algorithm=' + algorithm + '&heuristic=' + heuristic + '&mode=' + mode + '&paths=0' +
+        (timeoutMs > 0 ? '&timeoutMs=' + timeoutMs : ''), { method: 'POST' });
+    btnCancel.disabled = true;
     const data = await res.json();
-    pathDataArr = data.paths || [];
-    const firstPathLength = (pathDataArr[0] || []).length;
-    if (pendingResultIndexes.length === mazeDataArr.length) {
-        for (let i = 0; i < mazeDataArr.length; i++) {
+    // A stopped solve only has the paths of the mazes it finished, the others have length 0
+    const pathLengths = data.pathLengths || [];
+    if (data.complete === false) {
+        const finished = (data.solved || []).filter(s => s).length;
+        console.log('Solve stopped (' + data.stopReason + '): ' + finished + ' of ' + pathLengths.length + ' maze(s) finished');
+    }
+    const cells = batchInfo.width * batchInfo.height;
+    // Time spent generating mazes inside this solve, per maze (the batch is generated lazily)
+    const genMs = pathLengths.length && data.generationTime !== undefined ? data.generationTime / pathLengths.length : null;
+    mazeDataArr = new Array(batchInfo.numMazes).fill(null);
+    pathDataArr = new Array(batchInfo.numMazes).fill(null);
+    tileCache = new Map();
+    if (pendingResultIndexes.length === pathLengths.length) {
+        for (let i = 0; i < pathLengths.length; i++) {
             const resultIndex = pendingResultIndexes[i];
-            const pathLength = (pathDataArr[i] || []).length;
             results[resultIndex].gen = generatorName;
             results[resultIndex].algo = algorithmName;
+            results[resultIndex].genMs = genMs;
             results[resultIndex].solveMs = data.solvingTime;
-            results[resultIndex].pathLen = pathLength;
-            results[resultIndex].efficiency = ((pathLength / (mazeDataArr[i].width * mazeDataArr[i].height)) * 100).toFixed(2);
+            results[resultIndex].pathLen = pathLengths[i];
+            results[resultIndex].efficiency = ((pathLengths[i] / cells) * 100).toFixed(2);
         }
         pendingResultIndexes = [];
     } else {
-        for (let i = 0; i < mazeDataArr.length; i++) {
-            const pathLength = (pathDataArr[i] || []).length;
+        for (let i = 0; i < pathLengths.length; i++) {
             runCount++;
             results.push({
                 id: runCount, gen: generatorName, algo: algorithmName,
-                w: mazeDataArr[i].width, h: mazeDataArr[i].height,
-                cells: mazeDataArr[i].width * mazeDataArr[i].height,
-                genMs: mazeDataArr[i].generationTime,
+                w: batchInfo.width, h: batchInfo.height,
+                cells: cells,
+                genMs: genMs,
                 solveMs: data.solvingTime,
-                pathLen: pathLength,
-                efficiency: ((pathLength / (mazeDataArr[i].width * mazeDataArr[i].height)) * 100).toFixed(2)
+                pathLen: pathLengths[i],
+                efficiency: ((pathLengths[i] / cells) * 100).toFixed(2)
             });
         }
     }
     RenderResults();
     RenderMazeScroll();
 }
+// Stop the running solve, it returns the mazes finished so far
+document.getElementById('btnCancel').onclick = async () => {
+    await fetch('/cancel', { method: 'POST' });
+}
 // Clear results
 document.getElementById('btnClear').onclick = () => {
     results = [];
@@ -135,16 +166,104 @@ if (toggleViewBtn) {
     });
 }
 refreshToggleLabel();
-function RenderMazeScroll() {
+// Fetch one maze (and its path once solved). Without passages only size, start and finish are sent.
+async function LoadMaze(index, withPassages) {
+    const res = await fetch('/maze?index=' + index + (withPassages ? '' : '&passages=0'));
+    if (!res.ok) throw new Error('Maze request failed with status ' + res.status);
+    const data = await res.json();
+    mazeDataArr[index] = data.maze;
+    pathDataArr[index] = data.path || null;
+}
+async function RenderMazeScroll() {
     const canvas = document.getElementById('mazeCanvas');
-    if (!canvas) return;
-    const mazeData = mazeDataArr[currentMazeIdx];
-    const pathData = pathDataArr[currentMazeIdx] || [];
-    if (!mazeData) return;
-    if (graphMode) DrawGraph(canvas, mazeData, pathData);
-    else DrawMaze(canvas, mazeData, pathData);
+    if (!canvas || !batchInfo) return;
+    const index = currentMazeIdx;
     const info = document.getElementById('mazeIndexInfo');
-    if (info) info.textContent = `Maze ${currentMazeIdx + 1} of ${mazeDataArr.length}`;
+    if (info) info.textContent = `Maze ${index + 1} of ${mazeDataArr.length}`;
+    const tiled = batchInfo.width * batchInfo.height > TILE_CELLS_THRESHOLD;
+    try {
+        if (!mazeDataArr[index]) await LoadMaze(index, !tiled);
+    } catch (err) {
+        console.error('Maze fetch failed', err);
+        return;
+    }
+    if (index !== currentMazeIdx) return;   // Moved to another maze meanwhile
+    const mazeData = mazeDataArr[index];
+    const pathData = pathDataArr[index] || [];
+    if (tiled) DrawTiles(canvas, index, mazeData);
+    else if (graphMode) DrawGraph(canvas, mazeData, pathData);
+    else DrawMaze(canvas, mazeData, pathData);
+}
+// Tile of the wall grid as an image, 2 bits per pixel from /tile (see maze_tiles.h)
+async function LoadTile(index, zoom, tx, ty) {
+    const key = `${index}/${zoom}/${tx}/${ty}`;
+    if (tileCache.has(key)) return tileCache.get(key);
+    const promise = fetch(`/tile?maze=${index}&x=${tx}&y=${ty}&zoom=${zoom}`)
+        .then(res => {
+            if (!res.ok) throw new Error('Tile request failed with status ' + res.status);
+            return res.arrayBuffer();
+        })
+        .then(buffer => {
+            const packed = new Uint8Array(buffer);
+            const image = new ImageData(TILE_SIZE, TILE_SIZE);
+            for (let p = 0; p < TILE_SIZE * TILE_SIZE; p++) {
+                const color = TILE_COLORS[(packed[p >> 2] >> ((p & 3) * 2)) & 3];
+                image.data.set(color, p * 4);
+            }
+            return createImageBitmap(image);
+        })
+        .catch(err => {
+            tileCache.delete(key);  // Not cached, the next draw asks again
+            throw err;
+        });
+    tileCache.set(key, promise);
+    return promise;
+}
+// Draw a large maze from the tiles that are on screen, at the coarsest zoom that still gives a pixel per tile pixel
+async function DrawTiles(canvas, index, mazeData) {
+    const { width, height, start, finish } = mazeData;
+    const cell_size = Math.min(canvas.width / width, canvas.height / height);
+    const offset_x = (canvas.width - cell_size * width) / 2;
+    const offset_y = (canvas.height - cell_size * height) / 2;
+    const grid_px = cell_size / 2 * zoomLevel;     // Screen pixels per wall grid pixel
+    const zoom = Math.max(0, Math.min(8, Math.floor(Math.log2(1 / grid_px))));
+    const tile_span = TILE_SIZE * (1 << zoom);      // Grid pixels per tile
+    // Canvas point under a screen pixel, inverse of applyZoom
+    const toCanvas = (sx, sy) => [
+        canvas.width / 2 + (sx - canvas.width / 2 - panX) / zoomLevel,
+        canvas.height / 2 + (sy - canvas.height / 2 - panY) / zoomLevel
+    ];
+    const [cx0, cy0] = toCanvas(0, 0);
+    const [cx1, cy1] = toCanvas(canvas.width, canvas.height);
+    const grid_w = 2 * width + 1, grid_h = 2 * height + 1;
+    const tx0 = Math.max(0, Math.floor((cx0 - offset_x) * 2 / cell_size / tile_span));
+    const ty0 = Math.max(0, Math.floor((cy0 - offset_y) * 2 / cell_size / tile_span));
+    const tx1 = Math.min(Math.ceil(grid_w / tile_span) - 1, Math.floor((cx1 - offset_x) * 2 / cell_size / tile_span));
+    const ty1 = Math.min(Math.ceil(grid_h / tile_span) - 1, Math.floor((cy1 - offset_y) * 2 / cell_size / tile_span));
+    const tiles = [];
+    for (let ty = ty0; ty <= ty1; ty++) {
+        for (let tx = tx0; tx <= tx1; tx++) tiles.push(LoadTile(index, zoom, tx, ty).then(bitmap => ({ tx, ty, bitmap }), err => {
+            console.error('Tile fetch failed', err);
+            return { tx, ty, bitmap: null };    // Left blank this time, fetched again on the next draw
+        }));
+    }
+    const loaded = await Promise.all(tiles);
+    if (index !== currentMazeIdx) return;
+
+    const ctx = canvas.getContext('2d');
+    applyZoom(ctx, canvas);
+    ctx.fillStyle = '#1e1e1e';
+    ctx.fillRect(0, 0, canvas.width, canvas.height);
+    ctx.imageSmoothingEnabled = false;
+    const tile_canvas = tile_span * cell_size / 2;      // Canvas units per tile
+    loaded.forEach(({ tx, ty, bitmap }) => bitmap && ctx.drawImage(bitmap, offset_x + tx * tile_canvas, offset_y + ty * tile_canvas, tile_canvas, tile_canvas));
+    // Start & Finish, on the cell's grid pixel
+    const half = cell_size / 2;
+    ctx.fillStyle = '#4ec94e';
+    ctx.fillRect(offset_x + (2 * start.x + 1) * half, offset_y + (2 * start.y + 1) * half, half, half);
+    ctx.fillStyle = '#e05252';
+    ctx.fillRect(offset_x + (2 * finish.x + 1) * half, offset_y + (2 * finish.y + 1) * half, half, half);
+    ctx.setTransform(1, 0, 0, 1, 0, 0);
 }
 function clamp(v, min, max) { return Math.min(Math.max(v, min), max); }
 function setZoom(level) {
@@ -229,8 +348,8 @@ function RenderResults() {
     <td>${r.algo}</td>
     <td>${r.w}x${r.h}</td>
     <td>${r.cells}</td>
-    <td>${fmtMs(Number(r.genMs))}</td>
-    <td>${fmtMs(Number(r.solveMs))}</td>
+    <td>${fmtMs(r.genMs)}</td>
+    <td>${fmtMs(r.solveMs)}</td>
     <td>${r.pathLen === null ? '-' : r.pathLen}</td>
     <td>${r.efficiency === null ? '-' : r.efficiency + '%'}</td>
 </tr>
@@ -0,0 +1,204 @@
+#include "trace.h"
+
+#ifdef USE_MPI
+#include "mpi.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+std::atomic<bool> trace_enabled(false);
+
+// Fixed-size record so events can be shipped between ranks as raw bytes
+struct TraceEvent {
+    char name[24];
+    int64_t ts_us;
+    int64_t dur_us;
+    int32_t pid;    // MPI rank (0 without MPI)
+    int32_t tid;    // Per-rank thread number in order of first span
+    int32_t arg;
+};
+
+struct TraceBuffer {
+    int tid;
+    std::mutex mutex;   // The owning thread appends while TraceClear / TakeLocalEvents drain from other threads
+    std::vector<TraceEvent> events;
+};
+
+// Lock order: trace_mutex, then a buffer's mutex
+static std::mutex trace_mutex;
+static std::vector<TraceBuffer *> trace_buffers;    // One per live thread that has recorded a span
+static std::vector<TraceEvent> retired_events;      // Spans of threads that have exited, not taken yet
+static std::vector<int> free_tids;                  // Tids of exited threads, reused by new ones
+static std::vector<TraceEvent> gathered_events;     // Rank 0: events merged from all ranks
+static int64_t SteadyNowNs(){
+    return std::chrono::steady_clock::now().time_since_epoch() / std::chrono::nanoseconds(1);
+}
+
+// steady_clock nanoseconds when tracing was last enabled. Atomic: the pipeline stage threads read it outside maze_mutex.
+static std::atomic<int64_t> trace_epoch_ns(SteadyNowNs());
+
+/// @brief The calling thread's buffer, registered on its first span. When the thread exits (e.g. a pipeline stage)
+/// its spans move to retired_events and the buffer is unregistered, so short-lived threads leave nothing behind.
+class LocalTraceBuffer {
+public:
+    TraceBuffer *Get(){
+        if (!buffer){
+            buffer = std::make_unique<TraceBuffer>();
+            std::lock_guard<std::mutex> lock(trace_mutex);
+            if (free_tids.empty()){
+                buffer->tid = (int)trace_buffers.size();
+            } else {
+                buffer->tid = free_tids.back();
+                free_tids.pop_back();
+            }
+            trace_buffers.push_back(buffer.get());
+        }
+        return buffer.get();
+    }
+
+    ~LocalTraceBuffer(){
+        if (!buffer) return;
+        std::lock_guard<std::mutex> lock(trace_mutex);
+        {
+            std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+            retired_events.insert(retired_events.end(), buffer->events.begin(), buffer->events.end());
+        }
+        trace_buffers.erase(std::find(trace_buffers.begin(), trace_buffers.end(), buffer.get()));
+        free_tids.push_back(buffer->tid);
+    }
+
+private:
+    std::unique_ptr<TraceBuffer> buffer;
+};
+
+static thread_local LocalTraceBuffer local_buffer;
+
+/// @brief Microseconds since tracing was last enabled
+int64_t TraceNowUs(){
+    return (SteadyNowNs() - trace_epoch_ns.load(std::memory_order_relaxed)) / 1000;
+}
+
+/// @brief Append one finished span to the calling thread's buffer
+void TraceRecord(const char *name, int64_t begin_us, int64_t end_us, int arg){
+    TraceBuffer *buffer = local_buffer.Get();
+
+    TraceEvent ev{};
+    std::strncpy(ev.name, name, sizeof(ev.name) - 1);
+    ev.ts_us = begin_us;
+    ev.dur_us = end_us - begin_us;
+    ev.pid = 0;     // Filled in when gathered
+    ev.tid = buffer->tid;
+    ev.arg = arg;
+    std::lock_guard<std::mutex> lock(buffer->mutex);   // Uncontended unless the trace is being read
+    buffer->events.push_back(ev);
+}
+
+/// @brief Drop all recorded spans on this rank
+void TraceClear(){
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    for (TraceBuffer *buffer : trace_buffers){
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        buffer->events.clear();
+    }
+    retired_events.clear();
+    gathered_events.clear();
+}
+
+/// @brief Turn tracing on or off. Enabling clears old spans and resets the clock.
+/// Under MPI every rank calls this right after a common broadcast, so rank clocks line up to within the broadcast skew.
+void TraceEnable(bool enabled){
+    if (enabled){
+        TraceClear();
+        trace_epoch_ns.store(SteadyNowNs(), std::memory_order_relaxed);
+    }
+    trace_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+/// @brief Move this rank's thread buffers into one vector, tagging the rank
+static std::vector<TraceEvent> TakeLocalEvents(int rank){
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    std::vector<TraceEvent> events;
+    events.swap(retired_events);
+    for (TraceBuffer *buffer : trace_buffers){
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        events.insert(events.end(), buffer->events.begin(), buffer->events.end());
+        buffer->events.clear();
+    }
+    for (TraceEvent &ev : events) ev.pid = rank;
+    return events;
+}
+
+#ifdef USE_MPI
+/// @brief Collective: every rank sends its spans to rank 0, which appends them to the merged trace.
+void TraceGatherToRoot(){
+    int my_rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &my_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    std::vector<TraceEvent> local = TakeLocalEvents(my_rank);
+    int local_bytes = (int)(local.size() * sizeof(TraceEvent));
+
+    std::vector<int> counts(size, 0);
+    MPI_Gather(&local_bytes, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+    std::vector<int> displs(size, 0);
+    int total_bytes = 0;
+    for (int r = 0; r < size; r++){
+        displs[r] = total_bytes;
+        total_bytes += counts[r];
+    }
+
+    std::vector<TraceEvent> all(my_rank == 0 ? total_bytes / sizeof(TraceEvent) : 0);
+    MPI_Gatherv(local.data(), local_bytes, MPI_BYTE, all.data(), counts.data(), displs.data(), MPI_BYTE, 0, MPI_COMM_WORLD);
+
+    if (my_rank == 0){
+        std::lock_guard<std::mutex> lock(trace_mutex);
+        gathered_events.insert(gathered_events.end(), all.begin(), all.end());
+    }
+}
+#endif
+
+/// @brief Chrome trace-event JSON of the spans collected since the last call (load in chrome://tracing or
+/// ui.perfetto.dev). The returned spans are dropped, so every GET /trace only has new ones.
+std::string TraceToJSON(){
+#ifndef USE_MPI
+    {
+        std::vector<TraceEvent> local = TakeLocalEvents(0);
+        std::lock_guard<std::mutex> lock(trace_mutex);
+        gathered_events.insert(gathered_events.end(), local.begin(), local.end());
+    }
+#endif
+
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    std::ostringstream oss;
+    oss << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    // Metadata so each rank shows up as a named process
+    int max_pid = -1;
+    for (const TraceEvent &ev : gathered_events) max_pid = std::max(max_pid, (int)ev.pid);
+    bool first = true;
+    for (int pid = 0; pid <= max_pid; pid++){
+        if (!first) oss << ",";
+        first = false;
+        oss << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":0,\"args\":{\"name\":\"rank " << pid << "\"}}";
+    }
+
+    for (const TraceEvent &ev : gathered_events){
+        if (!first) oss << ",";
+        first = false;
+        oss << "{\"name\":\"" << ev.name << "\",\"ph\":\"X\"";
+        oss << ",\"ts\":" << ev.ts_us << ",\"dur\":" << ev.dur_us;
+        oss << ",\"pid\":" << ev.pid << ",\"tid\":" << ev.tid;
+        if (ev.arg >= 0) oss << ",\"args\":{\"index\":" << ev.arg << "}";
+        oss << "}";
+    }
+    oss << "]}";
+    gathered_events.clear();
+    return oss.str();
+}
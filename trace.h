@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Opt-in span tracer. Spans are recorded per thread (and per rank under MPI) and
+// exported as Chrome/Perfetto trace-event JSON. When tracing is off a TraceSpan
+// costs one relaxed atomic load.
+
+extern std::atomic<bool> trace_enabled;
+
+int64_t TraceNowUs();
+void TraceRecord(const char *name, int64_t begin_us, int64_t end_us, int arg);
+void TraceEnable(bool enabled);
+void TraceClear();
+std::string TraceToJSON();
+#ifdef USE_MPI
+void TraceGatherToRoot();
+#endif
+
+/// @brief RAII span, recorded from construction to destruction if tracing is enabled.
+/// @param name Static string naming the phase (generate, solve, drain_inbox, ...)
+/// @param arg Optional argument shown in the viewer, e.g. maze index. -1 if unused.
+class TraceSpan {
+public:
+    TraceSpan(const char *name, int arg = -1)
+        : name(name), arg(arg), begin_us(trace_enabled.load(std::memory_order_relaxed) ? TraceNowUs() : -1) {}
+
+    ~TraceSpan() {
+        if (begin_us >= 0) TraceRecord(name, begin_us, TraceNowUs(), arg);
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    const char *name;
+    int arg;
+    int64_t begin_us;
+};
@@ -0,0 +1,139 @@
+#include "tree_index.h"
+#include "maze.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+static const int BLOCK = 64;
+
+/// @brief Root the maze at cell 0 and build the Euler tour and range-minimum structure.
+/// Throws if the maze is not a spanning tree (extra passages or unreachable cells).
+TreeIndex::TreeIndex(const Maze& maze){
+    int num_cells = maze.width() * maze.height();
+    if ((int)maze.passages.size() != num_cells - 1) {
+        throw std::runtime_error("Maze is not a spanning tree");
+    }
+
+    parent.assign(num_cells, -1);
+    depth.assign(num_cells, -1);
+    cost.assign(num_cells, 0);
+    first.assign(num_cells, -1);
+    euler.reserve(2 * num_cells - 1);
+
+    // Iterative DFS, the stack holds (cell, next side to try)
+    std::vector<std::pair<int, int>> stack;
+    stack.emplace_back(0, 0);
+    depth[0] = 0;
+    first[0] = 0;
+    euler.push_back(0);
+
+    while (!stack.empty()){
+        int current = stack.back().first;
+        int &dir = stack.back().second;
+        uint8_t open = maze.OpenSides(current);
+
+        while (dir < 4 && (!(open & (1 << dir)) || maze.Neighbour(current, dir) == parent[current])) dir++;
+        if (dir == 4) {
+            stack.pop_back();
+            if (!stack.empty()) euler.push_back(stack.back().first);
+            continue;
+        }
+
+        int child = maze.Neighbour(current, dir);
+        parent[child] = current;
+        depth[child] = depth[current] + 1;
+        cost[child] = cost[current] + maze.Weight(current, dir++);
+        first[child] = (int)euler.size();
+        euler.push_back(child);
+        stack.emplace_back(child, 0);
+    }
+
+    if ((int)euler.size() != 2 * num_cells - 1) {
+        throw std::runtime_error("Maze is not a spanning tree");
+    }
+
+    // In-block masks: bit k of block_mask[i] is set if position (block start + k) is a suffix minimum of [block start, i]
+    int n = (int)euler.size();
+    block_mask.assign(n, 0);
+    int num_blocks = (n + BLOCK - 1) / BLOCK;
+    std::vector<int> block_min(num_blocks);
+    for (int b = 0; b < num_blocks; b++){
+        int begin = b * BLOCK;
+        int end = std::min(n, begin + BLOCK);
+        uint64_t mask = 0;
+        for (int i = begin; i < end; i++){
+            while (mask && depth[euler[begin + 63 - __builtin_clzll(mask)]] > depth[euler[i]]) {
+                mask &= ~(1ULL << (63 - __builtin_clzll(mask)));
+            }
+            mask |= 1ULL << (i - begin);
+            block_mask[i] = mask;
+        }
+        block_min[b] = InBlockMin(begin, end - 1);
+    }
+
+    // Sparse table over block minima: (n / 64) * log(n / 64) entries, below n for any realistic maze
+    block_sparse.push_back(block_min);
+    for (int level = 1; (1 << level) <= num_blocks; level++){
+        const std::vector<int> &prev = block_sparse.back();
+        std::vector<int> row(num_blocks - (1 << level) + 1);
+        for (int b = 0; b < (int)row.size(); b++){
+            row[b] = MinByDepth(prev[b], prev[b + (1 << (level - 1))]);
+        }
+        block_sparse.push_back(std::move(row));
+    }
+}
+
+int TreeIndex::MinByDepth(int i, int j) const {
+    return depth[euler[i]] <= depth[euler[j]] ? i : j;
+}
+
+/// @brief Position of the minimum in [l, r], both inside the same block
+int TreeIndex::InBlockMin(int l, int r) const {
+    int begin = l - l % BLOCK;
+    uint64_t mask = block_mask[r] & (~0ULL << (l - begin));
+    return begin + __builtin_ctzll(mask);
+}
+
+/// @brief Position of the minimum depth in euler[l..r]
+int TreeIndex::RangeMinIndex(int l, int r) const {
+    int lb = l / BLOCK;
+    int rb = r / BLOCK;
+    if (lb == rb) return InBlockMin(l, r);
+
+    int best = MinByDepth(InBlockMin(l, lb * BLOCK + BLOCK - 1), InBlockMin(rb * BLOCK, r));
+    if (rb - lb > 1) {
+        int from = lb + 1;
+        int count = rb - lb - 1;
+        int level = 31 - __builtin_clz(count);
+        best = MinByDepth(best, MinByDepth(block_sparse[level][from], block_sparse[level][rb - (1 << level)]));
+    }
+    return best;
+}
+
+/// @brief Lowest common ancestor of two cells
+int TreeIndex::Lca(int a, int b) const {
+    int l = first[a];
+    int r = first[b];
+    if (l > r) std::swap(l, r);
+    return euler[RangeMinIndex(l, r)];
+}
+
+/// @brief Cost of the path between two cells (number of steps in unweighted mazes)
+int TreeIndex::Distance(int a, int b) const {
+    return cost[a] + cost[b] - 2 * cost[Lca(a, b)];
+}
+
+/// @brief Cells on the unique path from a to b, both included
+std::vector<int> TreeIndex::Path(int a, int b) const {
+    int lca = Lca(a, b);
+    std::vector<int> path;
+    path.reserve(depth[a] + depth[b] - 2 * depth[lca] + 1);
+    for (int c = a; c != lca; c = parent[c]) path.push_back(c);
+    size_t up_len = path.size();
+    for (int c = b; c != lca; c = parent[c]) path.push_back(c);
+    path.push_back(lca);
+    // path = a..(below lca), b..(below lca), lca  ->  a..lca..b
+    std::reverse(path.begin() + up_len, path.end());
+    return path;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "maze.h"
+
+#include <cstdint>
+#include <vector>
+
+/// @brief Path index for perfect mazes. A perfect maze is a spanning tree, so the maze is rooted once,
+/// and an Euler tour with a range-minimum structure answers lowest-common-ancestor queries.
+/// Build is O(cells), distance queries are O(1) and path extraction is O(path length).
+/// Cells are addressed by maze index (y * width + x).
+class TreeIndex {
+public:
+    explicit TreeIndex(const Maze& maze);
+
+    int Lca(int a, int b) const;
+    int Distance(int a, int b) const;
+    std::vector<int> Path(int a, int b) const;
+
+private:
+    int RangeMinIndex(int l, int r) const;
+    int InBlockMin(int l, int r) const;
+    int MinByDepth(int i, int j) const;
+
+    std::vector<int> parent;        // Parent cell, -1 for the root
+    std::vector<int> depth;         // Steps from the root
+    std::vector<int> cost;          // Sum of passage weights from the root, equal to depth if the maze is unweighted
+    std::vector<int> first;         // First position of each cell in the Euler tour
+    std::vector<int> euler;         // Cells in DFS visiting order, 2 * cells - 1 entries
+
+    // Range minimum over depth[euler[i]]: 64-wide blocks with per-position stack masks,
+    // plus a sparse table over the block minima
+    std::vector<uint64_t> block_mask;
+    std::vector<std::vector<int>> block_sparse;
+};
@@ -0,0 +1,320 @@
+#include "verify.h"
+#include "solve_a_star.h"
+#include "maze_collection.h"
+#include "solve_planner.h"
+
+#include "omp.h"
+#ifdef USE_MPI
+#include "mpi.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/// @brief A fixed-seed batch of the verification suite
+struct VerifyCase {
+    int width, height, count;
+    double braid;
+    int max_weight;
+};
+
+/// @brief A solve of every case: the /solve parameters
+struct VerifyRun {
+    const char* mode;
+    const char* algorithm;
+    const char* heuristic;
+};
+
+// Varied shapes: many tiny mazes, corridors, odd sizes, loops (braid), terrain (weights) and a few large ones
+static const VerifyCase CASES[] = {
+    { 8, 8, 2000, 0, 1 },
+    { 1, 64, 300, 0, 1 },
+    { 64, 1, 300, 0, 1 },
+    { 31, 17, 1000, 0.3, 1 },
+    { 24, 24, 1000, 0, 9 },
+    { 100, 100, 40, 0.2, 5 },
+    { 200, 60, 10, 0, 1 },
+};
+static const uint32_t VERIFY_SEED = 4242;
+// Batches that solve in under a millisecond are timed over more repeats, until they add up to this
+static const double MIN_TIMED_MS = 100;
+static const int MAX_REPEATS = 50;
+// "auto" predictions are checked against the fastest solve, both taken as at least this (timer and scheduling noise)
+static const double MIN_PLAN_MS = 0.5;
+
+static const VerifyRun RUNS[] = {
+    { "sequential", "astar", "manhattan" },
+    { "sequential", "bidir", "manhattan" },
+    { "sequential", "bidir_par", "manhattan" },
+    { "sequential", "junction", "manhattan" },
+    { "sequential", "hpa", "manhattan" },
+    { "sequential", "bitboard", "manhattan" },
+    { "sequential", "lanes", "manhattan" },
+    { "inter", "astar", "manhattan" },
+    { "inter", "astar", "octile" },
+    { "inter", "astar", "euclidean" },
+    { "inter", "astar", "zero" },
+    { "inter", "bidir", "manhattan" },
+    { "inter", "bidir_par", "manhattan" },
+    { "inter", "junction", "manhattan" },
+    { "inter", "hpa", "manhattan" },
+    { "inter", "bitboard", "manhattan" },
+    { "inter", "lanes", "manhattan" },
+    { "intra", "astar", "manhattan" },
+    { "intra", "astar", "octile" },
+    { "intra", "astar", "zero" },
+    { "combined", "astar", "manhattan" },
+    { "auto", "astar", "manhattan" },
+    { "auto", "bidir", "manhattan" },
+    { "auto", "lanes", "manhattan" },
+};
+
+static double MsSince(std::chrono::steady_clock::time_point t0){
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+/// @brief Plain Dijkstra over the open sides, shares no code with the solvers it checks
+/// @return Cost of the cheapest path from start to finish, -1 if there is none
+static int ReferenceCost(const Maze& maze){
+    int start = maze.Index(maze.start);
+    int finish = maze.Index(maze.finish);
+    std::vector<int> dist((size_t)maze.width() * maze.height(), INT_MAX);
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> open;
+    dist[start] = 0;
+    open.push({ 0, start });
+    while (!open.empty()){
+        auto [d, index] = open.top();
+        open.pop();
+        if (d > dist[index]) continue;
+        if (index == finish) return d;
+        for (int dir = 0; dir < 4; dir++){
+            if (!(maze.OpenSides(index) & (1 << dir))) continue;
+            int next = maze.Neighbour(index, dir);
+            int nd = d + maze.Weight(index, dir);
+            if (nd < dist[next]){
+                dist[next] = nd;
+                open.push({ nd, next });
+            }
+        }
+    }
+    return -1;
+}
+
+/// @brief Cost of path i, checking that it runs from start to finish through open sides
+/// @return The cost, -1 for an empty path, -2 if the path is not valid
+static int PathCost(const Maze& maze, const PathSet& paths, size_t i){
+    size_t length = paths.Length(i);
+    if (length == 0) return -1;
+    const int32_t* cells = paths.Cells(i);
+    if (paths.Width(i) != maze.width() || cells[0] != maze.Index(maze.start) || cells[length - 1] != maze.Index(maze.finish)) return -2;
+    int cost = 0;
+    for (size_t step = 1; step < length; step++){
+        int dir = 0;
+        while (dir < 4 && !((maze.OpenSides(cells[step - 1]) & (1 << dir)) && maze.Neighbour(cells[step - 1], dir) == cells[step])) dir++;
+        if (dir == 4) return -2;
+        cost += maze.Weight(cells[step - 1], dir);
+    }
+    return cost;
+}
+
+static std::string CaseName(const VerifyCase& c){
+    char name[64];
+    snprintf(name, sizeof(name), "%dx%dx%d-b%g-w%d", c.width, c.height, c.count, c.braid, c.max_weight);
+    return name;
+}
+
+/// @brief Baseline key of a run: build, ranks and threads, case and solve parameters. Throughput is only compared
+/// between identical setups; for "auto" that includes the mode it picked, which depends on the calibration.
+static std::string BaselineKey(int size, const VerifyCase& c, const VerifyRun& run, const std::string& mode){
+#if defined(USE_MPI)
+    const char* build = "mpi";
+#elif defined(USE_OMP)
+    const char* build = "omp";
+#else
+    const char* build = "seq";
+#endif
+    return std::string(build) + "-np" + std::to_string(size) + "-t" + std::to_string(omp_get_max_threads()) + "/" + CaseName(c)
+        + "/" + mode + "/" + run.algorithm + "/" + run.heuristic;
+}
+
+/// @brief Read "key mazes_per_s" lines, '#' starts a comment line
+/// @return False if the file cannot be opened
+static bool ReadBaseline(const std::string& path, std::map<std::string, double>& baseline){
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)){
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string key;
+        double mazes_per_s;
+        if (fields >> key >> mazes_per_s) baseline[key] = mazes_per_s;
+    }
+    return true;
+}
+
+static bool WriteBaseline(const std::string& path, const std::map<std::string, double>& baseline){
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "# Solve throughput (mazes/s) per build-ranks-threads/case/mode/algorithm/heuristic, written by --verify --save-baseline\n";
+    for (const auto& [key, mazes_per_s] : baseline){
+        out << key << " " << mazes_per_s << "\n";
+    }
+    return (bool)out;
+}
+
+/// @brief Cross-solver regression check: solves fixed-seed batches of varied shapes with every mode, algorithm and
+/// heuristic, checks every path against a reference Dijkstra (valid and of optimal cost) and compares the throughput
+/// with a stored baseline. Collective under MPI, every rank must call it.
+/// @return Exit code, 0 if every run passed (same on every rank)
+int RunVerification(const VerifyOptions& options){
+    int my_rank = 0;
+    int size = 1;
+#ifdef USE_MPI
+    MPI_Comm_rank(MPI_COMM_WORLD, &my_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+#endif
+    // With a baseline every run needs its key: a new or renamed run (or "auto" picking another mode) fails as NOBASE
+    // until the baseline is saved again
+    bool compare = !options.baseline_path.empty() && !options.save_baseline;
+    std::map<std::string, double> baseline;
+    int runs = 0;
+    int failures = 0;
+    int regressions = 0;
+    int missing = 0;
+    int mispredictions = 0;
+    if (my_rank == 0 && !options.baseline_path.empty() && !ReadBaseline(options.baseline_path, baseline) && compare){
+        printf("[VERIFY] Cannot read baseline %s\n", options.baseline_path.c_str());
+        failures++;
+    }
+
+    for (size_t case_idx = 0; case_idx < sizeof(CASES) / sizeof(CASES[0]); case_idx++){
+        const VerifyCase& c = CASES[case_idx];
+        MazeOptions maze_options;
+        maze_options.braid = c.braid;
+        maze_options.max_weight = c.max_weight;
+        MazeCollection mazes;
+        mazes.Reset(c.width, c.height, c.count, VERIFY_SEED + (uint32_t)case_idx, maze_options);
+        // Build the whole batch up front so the timed solves exclude generation
+        while (mazes.Prefetch(0, mazes.size())) {}
+
+        std::vector<int> expected;
+        if (my_rank == 0){
+            expected.resize(c.count);
+            for (int i = 0; i < c.count; i++) expected[i] = ReferenceCost(*mazes.Get(i));
+        }
+
+        for (const VerifyRun& run : RUNS){
+            std::string error;
+            std::string mode = run.mode;
+            double best_ms = 0;
+            double total_ms = 0;
+            double predicted_ms = -1;   // "auto" only
+            double actual_ms = 0;
+            // Rank 0 keeps solving after a wrong path and decides when to stop, the workers follow
+            for (int r = 0, more = 1; more; r++){
+                PathSet paths;
+            #ifdef USE_MPI
+                MPI_Barrier(MPI_COMM_WORLD);
+            #endif
+                auto t0 = std::chrono::steady_clock::now();
+                try {
+                    paths = SolveSelected(mazes, run.mode, run.algorithm, run.heuristic);
+                } catch (const std::exception& e){
+                    error = e.what();   // Parameters are checked before any communication, so every rank throws
+                    break;
+                }
+                double ms = MsSince(t0);
+                if (r == 0 || ms < best_ms) best_ms = ms;
+                if (std::strcmp(run.mode, "auto") == 0){
+                    SolvePlan plan = TakeSolvePlan();
+                    mode = "auto-" + plan.mode;
+                    predicted_ms = plan.predicted_ms;
+                    if (r == 0 || plan.actual_ms < actual_ms) actual_ms = plan.actual_ms;
+                }
+                total_ms += ms;
+                more = r + 1 < options.repeats || (total_ms < MIN_TIMED_MS && r + 1 < MAX_REPEATS);
+            #ifdef USE_MPI
+                MPI_Bcast(&more, 1, MPI_INT, 0, MPI_COMM_WORLD);
+            #endif
+                if (my_rank != 0 || !error.empty()) continue;
+
+                if (paths.size() != (size_t)c.count){
+                    error = std::to_string(paths.size()) + " path(s) for " + std::to_string(c.count) + " maze(s)";
+                    continue;
+                }
+                for (int i = 0; i < c.count; i++){
+                    int cost = PathCost(*mazes.Get(i), paths, i);
+                    if (cost != expected[i]){
+                        error = "maze " + std::to_string(i) + ": " + (cost == -2 ? std::string("invalid path") : "cost " + std::to_string(cost))
+                            + ", expected " + std::to_string(expected[i]);
+                        break;
+                    }
+                }
+            }
+            if (my_rank != 0) continue;
+
+            runs++;
+            std::string key = BaselineKey(size, c, run, mode);
+            double mazes_per_s = best_ms > 0 ? c.count * 1000.0 / best_ms : 0;
+            if (!error.empty()){
+                failures++;
+                printf("[VERIFY] FAIL %s: %s\n", key.c_str(), error.c_str());
+                continue;
+            }
+            // A miscalibrated cost model picks the wrong mode without failing any path, so its prediction is checked too
+            if (predicted_ms >= 0){
+                double predicted = std::max(predicted_ms, MIN_PLAN_MS);
+                double actual = std::max(actual_ms, MIN_PLAN_MS);
+                if (std::max(predicted, actual) > std::min(predicted, actual) * options.plan_factor){
+                    mispredictions++;
+                    printf("[VERIFY] MISPREDICT %s: predicted %.2f ms, actual %.2f ms\n", key.c_str(), predicted_ms, actual_ms);
+                }
+            }
+            auto it = baseline.find(key);
+            if (options.save_baseline){
+                // The lowest of the saved runs, so the usual run-to-run spread stays above the baseline
+                baseline[key] = it != baseline.end() ? std::min(it->second, mazes_per_s) : mazes_per_s;
+                printf("[VERIFY] ok   %s: %.0f mazes/s\n", key.c_str(), mazes_per_s);
+            } else if (it != baseline.end() && mazes_per_s < it->second * (1 - options.tolerance)){
+                regressions++;
+                printf("[VERIFY] SLOW %s: %.0f mazes/s, baseline %.0f\n", key.c_str(), mazes_per_s, it->second);
+            } else if (it != baseline.end()){
+                printf("[VERIFY] ok   %s: %.0f mazes/s, baseline %.0f\n", key.c_str(), mazes_per_s, it->second);
+            } else if (compare){
+                missing++;
+                printf("[VERIFY] NOBASE %s: %.0f mazes/s\n", key.c_str(), mazes_per_s);
+            } else {
+                printf("[VERIFY] ok   %s: %.0f mazes/s\n", key.c_str(), mazes_per_s);
+            }
+        }
+    }
+
+    int exit_code = 0;
+    if (my_rank == 0){
+        // Merged into the file, so one baseline covers several builds and rank counts
+        bool saved = true;
+        if (options.save_baseline && !options.baseline_path.empty()){
+            saved = WriteBaseline(options.baseline_path, baseline);
+            if (!saved) printf("[VERIFY] Cannot write baseline %s\n", options.baseline_path.c_str());
+        }
+        printf("[VERIFY] %d run(s), %d failure(s), %d regression(s), %d without baseline, %d misprediction(s)\n", runs, failures, regressions, missing, mispredictions);
+        exit_code = failures > 0 || regressions > 0 || missing > 0 || mispredictions > 0 || !saved ? 1 : 0;
+    }
+#ifdef USE_MPI
+    MPI_Bcast(&exit_code, 1, MPI_INT, 0, MPI_COMM_WORLD);
+#endif
+    return exit_code;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+
+/// @brief Options of the `--verify` run (see RunVerification)
+struct VerifyOptions {
+    std::string baseline_path;  // Throughput baseline file, empty for none
+    bool save_baseline = false; // Record the measured throughput in baseline_path (keeping the lower one) instead of comparing
+    double tolerance = 0.4;     // Allowed throughput drop below the baseline, as a fraction
+    int repeats = 3;            // Timed solves per run (at least), the fastest one counts
+    double plan_factor = 3;     // Allowed ratio between the "auto" mode's predicted and actual time, either way
+};
+
+int RunVerification(const VerifyOptions& options);
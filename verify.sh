@@ -0,0 +1,30 @@
+# Cross-solver regression check: every build, and the MPI build with several rank and thread layouts.
+# Runs fail if they are slower than BASELINE by more than TOLERANCE, or missing from it. SAVE_BASELINE=1 records it.
+set -o pipefail
+make all || exit 1
+BASELINE=${BASELINE:-verify_baseline.txt}
+# MPI layouts as ranks:threads per rank; 2:2 covers the hybrid path (threaded shares per rank, threaded HDA rounds)
+VERIFY_MPI=${VERIFY_MPI:-"1:1 2:1 4:1 2:2"}
+TOLERANCE=${TOLERANCE:-0.4}
+if [ -n "$SAVE_BASELINE" ]; then
+    # The baseline keeps the slowest of the saved passes
+    ARGS="--baseline $BASELINE --save-baseline"
+    PASSES=${SAVE_PASSES:-3}
+elif [ -f "$BASELINE" ]; then
+    ARGS="--baseline $BASELINE --tolerance $TOLERANCE"
+    PASSES=1
+else
+    echo "No baseline $BASELINE, record one on the reference machine with SAVE_BASELINE=1"
+    exit 1
+fi
+status=0
+for pass in $(seq "$PASSES"); do
+    ./maze_seq --verify $ARGS | grep "^\[VERIFY\]" || status=1
+    ./maze_omp --verify $ARGS | grep "^\[VERIFY\]" || status=1
+    for layout in $VERIFY_MPI; do
+        np=${layout%:*}
+        threads=${layout#*:}
+        mpirun -np "$np" -x OMP_NUM_THREADS="$threads" ./maze_mpi --verify --threads "$threads" $ARGS | grep "^\[VERIFY\]" || status=1
+    done
+done
+exit $status
@@ -1,27 +1,45 @@
 #include "webgui.h"
 #include "httplib.h"
 #include "maze.h"
-#include "maze_generator.h"
+#include "maze_collection.h"
 #include "solve_a_star.h"
 #include "jsonifier.h"
 #include "mpi_controller.h"
+#include "trace.h"
+#include "tree_index.h"
+#include "hpa_star.h"
+#include "lpa_star.h"
+#include "pipeline.h"
+#include "maze_tiles.h"
+#include "solve_planner.h"
+#include "solve_cancel.h"
 #include <fstream>
 #include <chrono>
 #include <mutex>
 #include <algorithm>
 #include <deque>
+#include <memory>
+#include <sstream>
 #ifdef USE_MPI
 #include "mpi.h"
 #endif
 
 // Runtime choose solver via request parameter.
-// valid modes: inter, intra, combined, sequential
+// valid modes: inter, intra, combined, sequential, auto
+// valid algorithms: astar, bidir, bidir_par, junction, hpa, bitboard, lanes
+// valid heuristics (A* and HDA): manhattan, octile, euclidean, zero
 
-static std::vector<Maze> mazes;
-static MazeGenerator generator;
+static MazeCollection mazes;   // Generation parameters only, mazes are materialized on access
 static std::mutex maze_mutex;
-static std::vector<std::vector<Cell *>> previous_paths; // Store the previously solved paths to avoid re-solving
+static SharedPathSet previous_paths; // Store the previously solved paths to avoid re-solving
 static bool solution_cached = false;
+static std::vector<std::unique_ptr<TreeIndex>> tree_indexes;  // Built lazily per maze by /query
+// Built lazily per maze by /resolve. The maze pointer keeps the LPA* maze materialized while the solver exists.
+struct IncrementalSolver {
+    std::shared_ptr<Maze> maze;
+    std::unique_ptr<LpaStar> solver;
+};
+static std::vector<IncrementalSolver> incremental_solvers;
 
 static std::deque<std::string> log_lines;
 static std::mutex log_mutex;
@@ -46,6 +64,26 @@ static int GetIntParam(const httplib::Request req, const std::string& key, int d
     return defaultValue;
 }
 
+// Helper function to get floating point parameters from the request
+static double GetDoubleParam(const httplib::Request req, const std::string& key, double defaultValue) {
+    if (req.has_param(key)) {
+        try {
+            return std::stod(req.get_param_value(key));
+        } catch (const std::exception& e) {
+            std::cerr << "Invalid parameter for " << key << ": " << e.what() << "\n";
+        }
+    }
+    return defaultValue;
+}
+
+// Maze options from "braid" (fraction of dead ends removed, 0..1) and "maxWeight" (passage weights 1..maxWeight, at most 9)
+static MazeOptions GetMazeOptions(const httplib::Request& req) {
+    MazeOptions options;
+    options.braid = std::max(0.0, std::min(1.0, GetDoubleParam(req, "braid", 0.0)));
+    options.max_weight = std::max(1, std::min(9, GetIntParam(req, "maxWeight", 1)));
+    return options;
+}
+
 // Helper function to get string parameters from the request
 static std::string GetStrParam(const httplib::Request req, const std::string& key, const std::string& defaultValue) {
     if (req.has_param(key)) {
@@ -54,27 +92,39 @@ static std::string GetStrParam(const httplib::Request req, const std::string& ke
     return defaultValue;
 }
 
-static bool ModeValid(const std::string& mode){
-    return mode == "inter" || mode == "intra" || mode == "combined" || mode == "sequential";
+// Trace operations, mirrored on every MPI rank
+enum TraceOp : int {
+    TRACE_DISABLE = 0,
+    TRACE_ENABLE = 1,
+    TRACE_COLLECT = 2,
+};
+
+static void ApplyTraceOp(int trace_op){
+    if (trace_op == TRACE_ENABLE) {
+        TraceEnable(true);
+    } else if (trace_op == TRACE_DISABLE) {
+        TraceEnable(false);
+    } else if (trace_op == TRACE_COLLECT) {
+    #ifdef USE_MPI
+        TraceGatherToRoot();
+    #endif
+    }
 }
 
-static double GenerateMazes(int width, int height, int num_mazes, uint32_t seed) {
-    mazes.clear();
-    mazes.reserve(num_mazes);
-    generator.Seed(seed);
+static bool ModeValid(const std::string& mode){
+    return mode == "inter" || mode == "intra" || mode == "combined" || mode == "sequential" || mode == "auto";
+}
 
-    auto t0 = std::chrono::high_resolution_clock::now();
-    for (int i = 0; i < num_mazes; ++i) {
-        Maze maze(width, height);
-        generator.GeneratePrim(maze);
-        mazes.push_back(std::move(maze));
-    }
-    auto t1 = std::chrono::high_resolution_clock::now();
+// Replace the batch. Nothing is generated here, mazes are built from (seed, index) when first used.
+static void GenerateMazes(int width, int height, int num_mazes, uint32_t seed, const MazeOptions& options) {
+    incremental_solvers.clear();    // Drop the pins before the pages they hold
+    mazes.Reset(width, height, num_mazes, seed, options);
 
-    previous_paths.clear();
+    previous_paths.reset();
     solution_cached = false;
-
-    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+    tree_indexes.clear();
+    tree_indexes.resize(num_mazes);
+    incremental_solvers.resize(num_mazes);
 }
 
 // Request handler for maze generation
@@ -83,6 +133,7 @@ void RegisterGenerateHandler (httplib::Server& server){
         int width = std::max(2, std::min(500, GetIntParam(req, "width", 20)));
         int height = std::max(2, std::min(500, GetIntParam(req, "height", 20)));
         int num_mazes = std::max(1, std::min(10000, GetIntParam(req, "numMazes", 1)));
+        MazeOptions options = GetMazeOptions(req);
         std::lock_guard<std::mutex> lock(maze_mutex);
 
         if(num_mazes == 0){
@@ -92,16 +143,29 @@ void RegisterGenerateHandler (httplib::Server& server){
 
         uint32_t seed = static_cast<uint32_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
     #ifdef USE_MPI
-        MpiBroadcastGenerateCommand(width, height, num_mazes, seed);
+        MpiBroadcastGenerateCommand(width, height, num_mazes, seed, options);
     #endif
-        double generationTime = GenerateMazes(width, height, num_mazes, seed);
+        GenerateMazes(width, height, num_mazes, seed, options);
 
-        AppendLog("[GEN] Generated " + std::to_string(num_mazes) + " maze(s) " + std::to_string(width) + "x" + std::to_string(height) + " in " + std::to_string(generationTime) + " ms");
-        res.set_content(MazesToJSON(mazes, generationTime), "application/json");
+        // lazy=1: only the batch parameters, the client fetches mazes (or tiles) by index when it shows them
+        if (GetIntParam(req, "lazy", 0) != 0) {
+            AppendLog("[GEN] Batch of " + std::to_string(num_mazes) + " maze(s) " + std::to_string(width) + "x" + std::to_string(height) + " created, mazes are generated on access");
+            res.set_content(BatchToJSON(mazes, false, -1), "application/json");
+            return;
+        }
+
+        // Mazes are generated while they are serialized, so the span covers both
+        TraceSpan span("serialize");
+        double generationTime = 0;
+        std::string json = MazesToJSON(mazes, generationTime);
+        AppendLog("[GEN] Generated " + std::to_string(num_mazes) + " maze(s) " + std::to_string(width) + "x" + std::to_string(height) + " braid=" + std::to_string(options.braid)
+            + " maxWeight=" + std::to_string(options.max_weight) + " in " + std::to_string(generationTime) + " ms");
+        res.set_content(std::move(json), "application/json");
     });
 }
 
-// Post request handler for maze solving
+// Post request handler for maze solving. timeoutMs > 0 stops the solve after that long, POST /cancel stops it at once;
+// either way the response has the paths finished so far ("complete":false, see SolveStatusToJSON).
 void RegisterSolveHandler (httplib::Server& server){
     server.Post("/solve", [](const httplib::Request& req, httplib::Response& res){
         std::lock_guard<std::mutex> lock(maze_mutex);
@@ -118,25 +182,359 @@ void RegisterSolveHandler (httplib::Server& server){
             res.set_content("{\"error\":\"Invalid mode.\"}", "application/json");
             return;
         }
+        std::string algorithm = GetStrParam(req, "algorithm", "astar");
+        if (!BatchSolverForAlgorithm(algorithm)) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Invalid algorithm.\"}", "application/json");
+            return;
+        }
+        std::string heuristic = GetStrParam(req, "heuristic", "manhattan");
+        SearchHeuristic parsed_heuristic;
+        if (!ParseHeuristic(heuristic, parsed_heuristic)) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Invalid heuristic.\"}", "application/json");
+            return;
+        }
 
+        double timeout_ms = GetDoubleParam(req, "timeoutMs", 0);
+
+        ArmSolveCancel(timeout_ms);
     #ifdef USE_MPI
-        MpiBroadcastSolveCommand(mode);
+        MpiBroadcastSolveCommand(mode, algorithm, heuristic);
     #endif
-        std::vector<std::vector<Cell *>> paths = SolveSelected(mazes, mode);
+        SharedPathSet paths = std::make_shared<const PathSet>(SolveSelected(mazes, mode, algorithm, heuristic));
+        SolveStatus status = TakeSolveStatus();
+        DisarmSolveCancel();
         auto t1 = std::chrono::high_resolution_clock::now();
         double solvingTime = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        // Lazy batches are built while they are solved (rank 0's share under MPI); part of solvingTime
+        double generationTime = mazes.TakeGenerationMs();
 
-        AppendLog("[SOL] Mode=" + mode + " solved " + std::to_string(mazes.size()) + " maze(s) in " + std::to_string(solvingTime) + " ms");
+        AppendLog("[SOL] Mode=" + mode + " algorithm=" + algorithm + " heuristic=" + heuristic + " solved " + std::to_string(mazes.size()) + " maze(s) in " + std::to_string(solvingTime) + " ms ("
+            + std::to_string(solvingTime > 0 ? mazes.size() * 1000.0 / solvingTime : 0.0) + " mazes/s)");
+        if (mode == "auto") {
+            SolvePlan plan = TakeSolvePlan();
+            AppendLog("[AUTO] Chose " + plan.mode + ": predicted " + std::to_string(plan.predicted_ms) + " ms, actual " + std::to_string(plan.actual_ms)
+                + " ms (sequential " + std::to_string(plan.sequential_ms) + ", inter " + std::to_string(plan.inter_ms) + ", intra " + std::to_string(plan.intra_ms) + " ms predicted)");
+        }
+        if (status.stopped) {
+            int finished = (int)std::count(status.solved.begin(), status.solved.end(), 1);
+            AppendLog("[SOL] Stopped (" + status.reason + ") with " + std::to_string(finished) + " of " + std::to_string(mazes.size()) + " maze(s) finished"
+                + (status.bound_maze >= 0 ? ", maze " + std::to_string(status.bound_maze) + " cost in [" + std::to_string(status.lower_bound) + ", "
+                    + (status.upper_bound >= 0 ? std::to_string(status.upper_bound) : std::string("?")) + "]" : std::string()));
+        }
+        if (algorithm == "hpa") {
+            // Rank 0's share only under MPI
+            HpaTimings hpa = HpaTakeTimings();
+            AppendLog("[HPA] Preprocessing " + std::to_string(hpa.preprocess_ms) + " ms for " + std::to_string(hpa.graphs_built) + " maze(s), queries " + std::to_string(hpa.query_ms) + " ms for " + std::to_string(hpa.queries) + " maze(s)");
+        }
 
-        if (solution_cached && PathsEqual(paths, previous_paths)) {
-            res.set_content(PathsToJSON(previous_paths, solvingTime), "application/json");
+        TraceSpan span("serialize");
+        // paths=0: only the path lengths, the client fetches the paths it shows with /maze or /tile
+        bool with_paths = GetIntParam(req, "paths", 1) != 0;
+        if (!status.stopped && solution_cached && previous_paths && PathsEqual(*paths, *previous_paths)) {
+            res.set_content(with_paths ? PathsToJSON(*previous_paths, solvingTime, &status, generationTime)
+                : PathLengthsToJSON(*previous_paths, solvingTime, &status, generationTime), "application/json");
             AppendLog("[SOL] Cached result returned");
             return;
         }
 
-        previous_paths = paths;
+        previous_paths = paths;     // Shares the buffer, no copy. After a stop, the unfinished mazes have no path.
         solution_cached = true;
-        res.set_content(PathsToJSON(paths, solvingTime), "application/json");
+        res.set_content(with_paths ? PathsToJSON(*paths, solvingTime, &status, generationTime)
+            : PathLengthsToJSON(*paths, solvingTime, &status, generationTime), "application/json");
+    });
+
+    // Does not take maze_mutex, /solve holds it while it runs
+    server.Post("/cancel", [](const httplib::Request&, httplib::Response& res){
+        bool running = CancelSolve();
+        if (running) AppendLog("[SOL] Cancel requested");
+        res.set_content(std::string("{\"cancelled\":") + (running ? "true" : "false") + "}", "application/json");
+    });
+}
+
+// Browsing handlers for large batches, so clients only pull what they show:
+// GET /batch returns the batch parameters, GET /maze?index=i one maze (with its path once solved, or only size,
+// start and finish with passages=0), and GET /tile?maze=i&x=..&y=..&zoom=.. a packed 2-bit bitmap of part of the
+// maze's wall grid (see maze_tiles.h). Only the requested maze is materialized.
+void RegisterBrowseHandlers (httplib::Server& server){
+    server.Get("/batch", [](const httplib::Request&, httplib::Response& res){
+        std::lock_guard<std::mutex> lock(maze_mutex);
+        res.set_content(BatchToJSON(mazes, solution_cached && previous_paths, -1), "application/json");
+    });
+
+    server.Get("/maze", [](const httplib::Request& req, httplib::Response& res){
+        std::lock_guard<std::mutex> lock(maze_mutex);
+        int maze_idx = GetIntParam(req, "index", 0);
+        if (maze_idx < 0 || maze_idx >= mazes.size()) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Invalid maze index.\"}", "application/json");
+            return;
+        }
+        std::shared_ptr<Maze> maze = mazes.Get(maze_idx);
+        bool solved = solution_cached && previous_paths;
+        if (GetIntParam(req, "passages", 1) == 0) {
+            res.set_content(MazeSummaryToJSON(maze_idx, *maze, solved ? (long)previous_paths->Length(maze_idx) : -1), "application/json");
+        } else if (solved) {
+            res.set_content(MazeResultToJSON(maze_idx, *maze, *previous_paths, maze_idx), "application/json");
+        } else {
+            res.set_content(MazeToJSON(maze_idx, *maze), "application/json");
+        }
+    });
+
+    server.Get("/tile", [](const httplib::Request& req, httplib::Response& res){
+        std::lock_guard<std::mutex> lock(maze_mutex);
+        int maze_idx = GetIntParam(req, "maze", 0);
+        int zoom = GetIntParam(req, "zoom", 0);
+        if (maze_idx < 0 || maze_idx >= mazes.size() || zoom < 0 || zoom > MAX_TILE_ZOOM) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Invalid maze index or zoom.\"}", "application/json");
+            return;
+        }
+        std::shared_ptr<Maze> maze = mazes.Get(maze_idx);
+        bool solved = solution_cached && previous_paths;
+        const int32_t* path = solved ? previous_paths->Cells(maze_idx) : nullptr;
+        size_t path_length = solved ? previous_paths->Length(maze_idx) : 0;
+        res.set_content(RenderTile(*maze, path, path_length, GetIntParam(req, "x", 0), GetIntParam(req, "y", 0), zoom), "application/octet-stream");
+    });
+}
+
+// Pipelined handler: POST /generate_and_solve?width=..&height=..&numMazes=..&algorithm=..
+// Generates, solves and streams the batch at the same time, as newline-delimited JSON: a header line, one line per
+// maze ({"index", "maze", "path"}) and a line with the stage timings. The batch also replaces the current one,
+// so /solve, /query etc. work on it afterwards. The stages run on this process (rank 0 under MPI).
+void RegisterGenerateAndSolveHandler (httplib::Server& server){
+    server.Post("/generate_and_solve", [](const httplib::Request& req, httplib::Response& res){
+        int width = std::max(2, std::min(500, GetIntParam(req, "width", 20)));
+        int height = std::max(2, std::min(500, GetIntParam(req, "height", 20)));
+        int num_mazes = std::max(1, std::min(10000, GetIntParam(req, "numMazes", 1)));
+        MazeOptions options = GetMazeOptions(req);
+        std::string algorithm = GetStrParam(req, "algorithm", "astar");
+        SearchHeuristic heuristic;
+        if (!ParseHeuristic(GetStrParam(req, "heuristic", "manhattan"), heuristic)) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Invalid heuristic.\"}", "application/json");
+            return;
+        }
+        BatchSolver solver = BatchSolverForAlgorithm(algorithm, heuristic);
+        if (!solver) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Invalid algorithm.\"}", "application/json");
+            return;
+        }
+
+        int chunk_size = 1;
+        uint32_t seed = static_cast<uint32_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+        {
+            std::lock_guard<std::mutex> lock(maze_mutex);
+        #ifdef USE_MPI
+            MpiBroadcastGenerateCommand(width, height, num_mazes, seed, options);
+        #endif
+            GenerateMazes(width, height, num_mazes, seed, options);
+            chunk_size = mazes.PageSize();
+        }
+
+        // The pipeline builds its own mazes, so it runs outside maze_mutex while the response streams
+        auto pipeline = std::make_shared<GenerateSolvePipeline>(width, height, num_mazes, seed, options, solver, chunk_size);
+        std::string label = std::to_string(num_mazes) + " maze(s) " + std::to_string(width) + "x" + std::to_string(height) + " algorithm=" + algorithm + " heuristic=" + HeuristicName(heuristic);
+        res.set_chunked_content_provider("application/x-ndjson",
+            [pipeline, label](size_t, httplib::DataSink& sink) {
+                std::string piece;
+                if (pipeline->Next(piece)) return sink.write(piece.data(), piece.size());
+                PipelineTimings t = pipeline->Timings();
+                AppendLog("[PIP] " + label + " streamed in " + std::to_string(t.total_ms) + " ms (generate " + std::to_string(t.generate_ms)
+                    + " ms, solve " + std::to_string(t.solve_ms) + " ms, serialize " + std::to_string(t.serialize_ms) + " ms)");
+                sink.done();
+                return true;
+            },
+            [pipeline](bool) { pipeline->Stop(); });
+    });
+}
+
+// Parse "x1 y1 x2 y2 ..." (any non-digit separators) into cell index pairs. Out-of-range cells become -1.
+static std::vector<std::pair<int, int>> ParseCellPairs(const std::string& text, const Maze& maze) {
+    std::vector<int> numbers;
+    std::string cleaned = text;
+    for (char &c : cleaned) {
+        if (!std::isdigit(static_cast<unsigned char>(c)) && c != '-') c = ' ';
+    }
+    std::istringstream iss(cleaned);
+    int value;
+    while (iss >> value) numbers.push_back(value);
+
+    auto to_index = [&](int x, int y) {
+        if (x < 0 || x >= maze.width() || y < 0 || y >= maze.height()) return -1;
+        return y * maze.width() + x;
+    };
+    std::vector<std::pair<int, int>> pairs;
+    for (size_t i = 0; i + 3 < numbers.size(); i += 4) {
+        pairs.emplace_back(to_index(numbers[i], numbers[i + 1]), to_index(numbers[i + 2], numbers[i + 3]));
+    }
+    return pairs;
+}
+
+// Batch pair query handler: POST /query?maze=i[&paths=1] with body "x1,y1,x2,y2;x1,y1,x2,y2;..."
+// Answers from the maze's tree index, which is built on first use
+void RegisterQueryHandler (httplib::Server& server){
+    server.Post("/query", [](const httplib::Request& req, httplib::Response& res){
+        std::lock_guard<std::mutex> lock(maze_mutex);
+
+        int maze_idx = GetIntParam(req, "maze", 0);
+        if (maze_idx < 0 || maze_idx >= mazes.size()) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Invalid maze index.\"}", "application/json");
+            return;
+        }
+        std::shared_ptr<Maze> pinned = mazes.Get(maze_idx);
+        const Maze& maze = *pinned;
+        bool with_paths = GetIntParam(req, "paths", 0) != 0;
+
+        auto t0 = std::chrono::high_resolution_clock::now();
+        if (!tree_indexes[maze_idx]) {
+            try {
+                tree_indexes[maze_idx] = std::make_unique<TreeIndex>(maze);
+            } catch (const std::exception& e) {
+                res.status = 400;
+                res.set_content(std::string("{\"error\":\"") + e.what() + "\"}", "application/json");
+                return;
+            }
+        }
+        const TreeIndex& index = *tree_indexes[maze_idx];
+
+        std::vector<std::pair<int, int>> pairs = ParseCellPairs(req.body, maze);
+        std::vector<int> distances;
+        std::vector<std::vector<int>> paths;
+        distances.reserve(pairs.size());
+        for (const auto& [from, to] : pairs) {
+            bool valid = from >= 0 && to >= 0;
+            distances.push_back(valid ? index.Distance(from, to) : -1);
+            if (with_paths) paths.push_back(valid ? index.Path(from, to) : std::vector<int>());
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        double queryTime = std::chrono::duration<double, std::milli>(t1 - t0).count();
+
+        AppendLog("[QRY] Answered " + std::to_string(pairs.size()) + " pair(s) on maze " + std::to_string(maze_idx) + " in " + std::to_string(queryTime) + " ms");
+        res.set_content(PairQueriesToJSON(maze, distances, paths, queryTime), "application/json");
+    });
+}
+
+// Neighbour offsets per wall direction (east, south, west, north), same order as the Side flags
+static const int wall_dx[4] = { 1, 0, -1, 0 };
+static const int wall_dy[4] = { 0, 1,  0, -1 };
+
+static int DirFromName(const std::string& name) {
+    if (name == "east") return 0;
+    if (name == "south") return 1;
+    if (name == "west") return 2;
+    if (name == "north") return 3;
+    return -1;
+}
+
+// Open or close a wall of maze_idx, on this rank. Arguments must already be validated.
+// The collection logs the edit, so it survives the maze being evicted and rebuilt.
+static bool ApplyWallEdit(int maze_idx, int x, int y, int dir, bool open) {
+    if (!mazes.SetWall(maze_idx, x, y, dir, open)) return false;
+
+    tree_indexes[maze_idx].reset();
+    IncrementalSolver& incremental = incremental_solvers[maze_idx];
+    if (incremental.solver) {
+        Maze& maze = *incremental.maze;
+        incremental.solver->PassageChanged(&maze.cells[y][x], &maze.cells[y + wall_dy[dir]][x + wall_dx[dir]]);
+    }
+    solution_cached = false;
+    return true;
+}
+
+// Wall edit handler: POST /wall?maze=i&x=..&y=..&dir=east|south|west|north[&open=0|1]
+// Without "open" the wall is toggled. The edit is mirrored on every MPI rank.
+void RegisterWallHandler (httplib::Server& server){
+    server.Post("/wall", [](const httplib::Request& req, httplib::Response& res){
+        std::lock_guard<std::mutex> lock(maze_mutex);
+
+        int maze_idx = GetIntParam(req, "maze", 0);
+        int x = GetIntParam(req, "x", -1);
+        int y = GetIntParam(req, "y", -1);
+        int dir = DirFromName(GetStrParam(req, "dir", ""));
+        if (maze_idx < 0 || maze_idx >= mazes.size() || dir < 0) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Invalid maze index or direction.\"}", "application/json");
+            return;
+        }
+        std::shared_ptr<Maze> pinned = mazes.Get(maze_idx);
+        Maze& maze = *pinned;
+        int nx = x + wall_dx[dir];
+        int ny = y + wall_dy[dir];
+        if (x < 0 || x >= maze.width() || y < 0 || y >= maze.height() || nx < 0 || nx >= maze.width() || ny < 0 || ny >= maze.height()) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Wall is outside the maze.\"}", "application/json");
+            return;
+        }
+
+        bool is_open = maze.HasPassage(&maze.cells[y][x], &maze.cells[ny][nx]);
+        bool open = req.has_param("open") ? GetIntParam(req, "open", 0) != 0 : !is_open;
+        bool changed = open != is_open;
+        if (changed) {
+        #ifdef USE_MPI
+            MpiBroadcastEditCommand(maze_idx, x, y, dir, open);
+        #endif
+            ApplyWallEdit(maze_idx, x, y, dir, open);
+            AppendLog("[EDT] Maze " + std::to_string(maze_idx) + " wall (" + std::to_string(x) + "," + std::to_string(y) + ") " + GetStrParam(req, "dir", "") + (open ? " opened" : " closed"));
+        }
+        res.set_content(std::string("{\"changed\":") + (changed ? "true" : "false") + ",\"open\":" + (open ? "true" : "false") + "}", "application/json");
+    });
+}
+
+// Incremental solve handler: POST /resolve?maze=i returns the current path of one maze.
+// The LPA* state is kept between calls, so after wall edits only the affected cells are re-expanded.
+void RegisterResolveHandler (httplib::Server& server){
+    server.Post("/resolve", [](const httplib::Request& req, httplib::Response& res){
+        std::lock_guard<std::mutex> lock(maze_mutex);
+
+        int maze_idx = GetIntParam(req, "maze", 0);
+        if (maze_idx < 0 || maze_idx >= mazes.size()) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Invalid maze index.\"}", "application/json");
+            return;
+        }
+
+        auto t0 = std::chrono::high_resolution_clock::now();
+        IncrementalSolver& incremental = incremental_solvers[maze_idx];
+        if (!incremental.solver) {
+            incremental.maze = mazes.Get(maze_idx);
+            incremental.solver = std::make_unique<LpaStar>(*incremental.maze);
+        }
+        LpaStar& solver = *incremental.solver;
+        PathSet path;
+        path.Append(*incremental.maze, solver.Solve());
+        auto t1 = std::chrono::high_resolution_clock::now();
+        double solvingTime = std::chrono::duration<double, std::milli>(t1 - t0).count();
+
+        AppendLog("[INC] Maze " + std::to_string(maze_idx) + " re-solved with " + std::to_string(solver.LastExpansions()) + " expansion(s) in " + std::to_string(solvingTime) + " ms");
+        res.set_content(PathsToJSON(path, solvingTime), "application/json");
+    });
+}
+
+// Trace handlers: POST /trace?enable=1|0 switches tracing on every rank, GET /trace returns the merged Chrome trace JSON
+void RegisterTraceHandler (httplib::Server& server){
+    server.Post("/trace", [](const httplib::Request& req, httplib::Response& res){
+        std::lock_guard<std::mutex> lock(maze_mutex);
+        int trace_op = GetIntParam(req, "enable", 1) ? TRACE_ENABLE : TRACE_DISABLE;
+    #ifdef USE_MPI
+        MpiBroadcastTraceCommand(trace_op);
+    #endif
+        ApplyTraceOp(trace_op);
+
+        AppendLog(std::string("[TRC] Tracing ") + (trace_op == TRACE_ENABLE ? "enabled" : "disabled"));
+        res.set_content(std::string("{\"tracing\":") + (trace_op == TRACE_ENABLE ? "true" : "false") + "}", "application/json");
+    });
+
+    server.Get("/trace", [](const httplib::Request&, httplib::Response& res){
+        std::lock_guard<std::mutex> lock(maze_mutex);
+    #ifdef USE_MPI
+        MpiBroadcastTraceCommand(TRACE_COLLECT);
+    #endif
+        ApplyTraceOp(TRACE_COLLECT);
+        res.set_content(TraceToJSON(), "application/json");
     });
 }
 
@@ -189,21 +587,63 @@ void StartWebServer(){
 
     RegisterSolveHandler(server);
 
+    RegisterGenerateAndSolveHandler(server);
+
+    RegisterBrowseHandlers(server);
+
+    RegisterTraceHandler(server);
+
+    RegisterQueryHandler(server);
+
+    RegisterWallHandler(server);
+
+    RegisterResolveHandler(server);
+
+    // Graceful shutdown: stop accepting requests, then release the MPI workers so every rank can finalize
+    server.Post("/shutdown", [&server](const httplib::Request&, httplib::Response& res){
+        AppendLog("[SRV] Shutting down");
+        res.set_content("{\"shutdown\":true}", "application/json");
+        server.stop();
+    });
+
     int port = 8080;
     printf("Server running at http://localhost:%d\n", port);
     server.listen("0.0.0.0", port);
+
+#ifdef USE_MPI
+    std::lock_guard<std::mutex> lock(maze_mutex);
+    MpiBroadcastShutdownCommand();
+#endif
 }
 
 void RunMpiWorkerLoop(){
 #ifdef USE_MPI
+    int rank = 0;
+    int size = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
     MpiRunWorkerLoop(
-        [](int width, int height, int num_mazes, uint32_t seed) {
+        [](int width, int height, int num_mazes, uint32_t seed, const MazeOptions& options) {
+            std::lock_guard<std::mutex> lock(maze_mutex);
+            GenerateMazes(width, height, num_mazes, seed, options);
+        },
+        [](const std::string& mode, const std::string& algorithm, const std::string& heuristic) {
+            std::lock_guard<std::mutex> lock(maze_mutex);
+            (void)SolveSelected(mazes, mode, algorithm, heuristic);
+        },
+        [](int trace_op) {
+            std::lock_guard<std::mutex> lock(maze_mutex);
+            ApplyTraceOp(trace_op);
+        },
+        [](int maze_idx, int x, int y, int dir, bool open) {
             std::lock_guard<std::mutex> lock(maze_mutex);
-            (void)GenerateMazes(width, height, num_mazes, seed);
+            ApplyWallEdit(maze_idx, x, y, dir, open);
         },
-        [](const std::string& mode) {
+        [rank, size]() {
+            // Between commands, generate this rank's share of the inter-maze split (same split as SolveMPI)
             std::lock_guard<std::mutex> lock(maze_mutex);
-            (void)SolveSelected(mazes, mode);
+            int per_rank = (mazes.size() + size - 1) / size;
+            return mazes.Prefetch(rank * per_rank, std::min(mazes.size(), (rank + 1) * per_rank));
         });
 #endif
 }
\ No newline at end of file